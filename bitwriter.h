@@ -17,7 +17,9 @@
 #include "config/aom_config.h"
 
 #include "aom_dsp/entenc.h"
+#include "aom_dsp/entenc_pipe.h"
 #include "aom_dsp/prob.h"
+#include "aom_dsp/pwdc_adapt.h"
 
 #if CONFIG_RD_DEBUG
 #include "av1/common/blockd.h"
@@ -32,11 +34,13 @@
 extern "C" {
 #endif
 
+/*Every field aom_write() and aom_write_symbol() touch comes first:
+   allow_update_cdf, then the hot part of ec.*/
 struct aom_writer {
+  uint8_t allow_update_cdf;
+  od_ec_enc ec;
   unsigned int pos;
   uint8_t *buffer;
-  od_ec_enc ec;
-  uint8_t allow_update_cdf;
 };
 
 typedef struct aom_writer aom_writer;
@@ -69,17 +73,32 @@ int aom_stop_encode(aom_writer *w);
 int aom_tell_size(aom_writer *w);
 
 static inline void aom_write(aom_writer *w, int bit, int probability) {
-  int p = (0x7FFFFF - (probability << 15) + probability) >> 8;
+  int p = od_ec_prob8_q15[probability];
 #if CONFIG_BITSTREAM_DEBUG
   aom_cdf_prob cdf[2] = { (aom_cdf_prob)p, 32767 };
   bitstream_queue_push(bit, cdf, 2);
 #endif
 
+  if (w->ec.symbuf != NULL) {
+    od_ec_symbuf_push(w->ec.symbuf, p, 0, bit, 0, 0);
+    return;
+  }
   od_ec_encode_bool_q15(&w->ec, bit, p);
 }
 
 static inline void aom_write_bit(aom_writer *w, int bit) {
-  aom_write(w, bit, 128);  // aom_prob_half
+  // aom_write(w, bit, 128) (aom_prob_half), with the equiprobable kernel.
+  const int p = 16384;
+#if CONFIG_BITSTREAM_DEBUG
+  aom_cdf_prob cdf[2] = { (aom_cdf_prob)p, 32767 };
+  bitstream_queue_push(bit, cdf, 2);
+#endif
+
+  if (w->ec.symbuf != NULL) {
+    od_ec_symbuf_push(w->ec.symbuf, p, 0, bit, 0, 0);
+    return;
+  }
+  od_ec_encode_bool_half(&w->ec, bit);
 }
 
 static inline void aom_write_literal(aom_writer *w, int data, int bits) {
@@ -94,12 +113,35 @@ static inline void aom_write_cdf(aom_writer *w, int symb,
   bitstream_queue_push(symb, cdf, nsymbs);
 #endif
 
-  od_ec_encode_cdf_q15(&w->ec, symb, cdf, nsymbs);
+  // In deferred mode only the probabilities are captured here; the CDF is
+  // free to adapt before the record is coded.
+  if (w->ec.symbuf != NULL) {
+    od_ec_symbuf *sb = w->ec.symbuf;
+    const unsigned ctx =
+        sb->ctx_keys != NULL ? od_ec_symbuf_context(sb, cdf) : 0;
+    od_ec_symbuf_push(sb, symb > 0 ? cdf[symb - 1] : OD_ICDF(0), cdf[symb],
+                      symb, nsymbs, ctx);
+    return;
+  }
+  // Most call sites pass a constant nsymbs, in which case this switch folds
+  // to a direct call of the specialized kernel.
+  switch (nsymbs) {
+#define AOM_WRITE_CDF_CASE(n)                       \
+  case n:                                           \
+    od_ec_encode_cdf_q15_##n(&w->ec, symb, cdf);  \
+    return;
+    OD_EC_CDF_SIZES(AOM_WRITE_CDF_CASE)
+#undef AOM_WRITE_CDF_CASE
+    default: od_ec_encode_cdf_q15(&w->ec, symb, cdf, nsymbs); return;
+  }
 }
 
 static inline void aom_write_symbol(aom_writer *w, int symb, aom_cdf_prob *cdf,
                                     int nsymbs) {
   aom_write_cdf(w, symb, cdf, nsymbs);
+  if (w->ec.adapt != NULL) {
+    pwdc_adapt_observe(w->ec.adapt, cdf, symb, nsymbs);
+  }
   if (w->allow_update_cdf) update_cdf(cdf, symb, nsymbs);
 }
 
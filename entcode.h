@@ -33,6 +33,15 @@ typedef uint32_t od_ec_window;
 
 #define OD_ICDF AOM_ICDF
 
+/*The storage class of the per-thread PWDC statistics.*/
+#if defined(__GNUC__)
+#define OD_EC_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#define OD_EC_THREAD_LOCAL __declspec(thread)
+#else
+#define OD_EC_THREAD_LOCAL _Thread_local
+#endif
+
 /*See entcode.c for further documentation.*/
 
 OD_WARN_UNUSED_RESULT uint32_t od_ec_tell_frac(uint32_t nbits_total,
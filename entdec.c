@@ -0,0 +1,456 @@
+/*
+ * Copyright (c) 2001-2016, Alliance for Open Media. All rights reserved.
+ * Modified 2026: PWDC (Photonic Wavelength Division Compression) statistics
+ * and decode fast paths.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "aom_dsp/entdec.h"
+#include "aom_dsp/prob.h"
+#include "aom_util/endian_inl.h"
+
+/*Set to 1 to search icdf rows of 8 or more symbols with SSE2, AVX2 or NEON,
+   whichever the target enables. This only pays off when the CDFs are fixed
+   and the symbols spread over the whole row (about 10% with AVX2 on the flat
+   trace of pwdc_dec_test.c). On symbols skewed towards 0, as most AV1
+   symbols are, the early-exit scalar loop usually stops at the first
+   threshold, and when every symbol is followed by update_cdf(), as in the
+   adaptive AV1 path, its branches prime the predictor for the ones in
+   update_cdf(); it is faster in both cases.*/
+#if !defined(OD_EC_DEC_SIMD)
+#define OD_EC_DEC_SIMD (0)
+#endif
+
+#if OD_EC_DEC_SIMD && defined(__AVX2__)
+#include <immintrin.h>
+#define OD_EC_DEC_SEARCH_AVX2 (1)
+#elif OD_EC_DEC_SIMD &&                      \
+    (defined(__SSE2__) || defined(_M_X64) || \
+     (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define OD_EC_DEC_SEARCH_SSE2 (1)
+#elif OD_EC_DEC_SIMD && defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define OD_EC_DEC_SEARCH_NEON (1)
+#endif
+
+/*A range decoder.
+  This is an entropy decoder based upon \cite{Mar79}, which is itself a
+   rediscovery of the FIFO arithmetic code introduced by \cite{Pas76}.
+  It is very similar to arithmetic encoding, except that encoding is done with
+   digits in any base, instead of with bits, and so it is faster when using
+   larger bases (i.e.: a byte).
+  The author claims an average waste of $\frac{1}{2}\log_b(2b)$ bits, where $b$
+   is the base, longer than the theoretical optimum, but to my knowledge there
+   is no published justification for this claim.
+  This only seems true when using near-infinite precision arithmetic so that
+   the process is carried out with no rounding errors.
+
+  An excellent textbook description is provided by Witten, Moffat, and Bell,
+   "Managing Gigabytes".
+
+  @INPROCEEDINGS{Pas76,
+    author="Richard Clark Pasco",
+    title="Source coding algorithms for fast data compression",
+    booktitle="Ph.D. thesis",
+    address="Dept. of Electrical Engineering, Stanford University",
+    month=May,
+    year=1976
+  }
+  @INPROCEEDINGS{Mar79,
+   author="Martin, G.N.N.",
+   title="Range encoding: an algorithm for removing redundancy from a digitised
+    message",
+   booktitle="Video & Data Recording Conference",
+   year=1979,
+   address="Southampton",
+   month=Jul
+  }*/
+
+/*This is meant to be a large, positive constant that can still be efficiently
+   loaded as an immediate (on platforms like ARM, for example).
+  Even relatively modest values like 100 would work fine.*/
+#define OD_EC_LOTS_OF_BITS (0x4000)
+
+/* ========== PWDC Statistics Collector ========== */
+
+/* Map a symbol value to a "wavelength channel" (0-127), as in entenc.c */
+static unsigned int pwdc_symbol_to_channel(int s, int nsyms) {
+  if (nsyms <= 1) return 0;
+  return (unsigned int)((s * 128) / nsyms);
+}
+
+/* Per thread, like the encoder's, so tile decoders never race. */
+static OD_EC_THREAD_LOCAL pwdc_dec_stats g_pwdc_dec_stats = { 0 };
+
+static void pwdc_dec_record_symbol(int s, int nsyms) {
+  g_pwdc_dec_stats.total_symbols++;
+  unsigned int ch = pwdc_symbol_to_channel(s, nsyms);
+  if (ch < 128) g_pwdc_dec_stats.channel_hits[ch]++;
+}
+
+static void pwdc_dec_record_bool(int val) {
+  g_pwdc_dec_stats.total_symbols++;
+  g_pwdc_dec_stats.bool_count[val ? 1 : 0]++;
+}
+
+void pwdc_dec_stats_get(pwdc_dec_stats *stats) { *stats = g_pwdc_dec_stats; }
+
+void pwdc_dec_stats_reset(void) {
+  memset(&g_pwdc_dec_stats, 0, sizeof(g_pwdc_dec_stats));
+}
+
+/* ========== Range Decoder ========== */
+
+/*The return value of od_ec_dec_tell does not change across an od_ec_dec_refill
+   call.*/
+static void od_ec_dec_refill(od_ec_dec *dec) {
+  int s;
+  od_ec_dec_window dif;
+  int16_t cnt;
+  const unsigned char *bptr;
+  const unsigned char *end;
+  dif = dec->dif;
+  cnt = dec->cnt;
+  bptr = dec->bptr;
+  end = dec->end;
+  s = OD_EC_DEC_WINDOW_SIZE - 9 - (cnt + 15);
+  g_pwdc_dec_stats.refill_count++;
+#if OD_EC_DEC_WIDE_WINDOW
+  if (s >= 0 && end - bptr >= 8) {
+    /*Away from the end of the buffer, read the bytes that fit in one go: the
+       k of them land at shifts s, s - 8, ..., s & 7.*/
+    const int k = (s >> 3) + 1;
+    uint64_t bytes;
+    memcpy(&bytes, bptr, sizeof(bytes));
+    bytes = HToBE64(bytes);
+    dif ^= (bytes >> (64 - 8 * k)) << (s & 7);
+    dec->dif = dif;
+    dec->cnt = (int16_t)(cnt + 8 * k);
+    dec->bptr = bptr + k;
+    return;
+  }
+#endif
+  for (; s >= 0 && bptr < end; s -= 8, bptr++) {
+    /*Each time a byte is inserted into the window (dif), bptr advances and cnt
+       is incremented by 8, so the total number of consumed bits (the return
+       value of od_ec_dec_tell) does not change.*/
+    assert(s <= OD_EC_DEC_WINDOW_SIZE - 8);
+    dif ^= (od_ec_dec_window)bptr[0] << s;
+    cnt += 8;
+  }
+  if (bptr >= end) {
+    /*We've reached the end of the buffer. It is perfectly valid for us to need
+       to fill the window with additional bits past the end of the buffer (and
+       this happens in normal operation). These bits should all just be taken
+       as zero. But we cannot increment bptr past 'end' (this is undefined
+       behavior), so we start to increment dec->tell_offs. We also don't want
+       to keep testing bptr against 'end', so we set cnt to OD_EC_LOTS_OF_BITS
+       and adjust dec->tell_offs so that the total number of unconsumed bits in
+       the window (dec->cnt - dec->tell_offs) does not change. This effectively
+       puts lots of zero bits into the window, and means we won't try to refill
+       it from the buffer for a very long time (at which point we'll put lots
+       of zero bits into the window again).*/
+    dec->tell_offs += OD_EC_LOTS_OF_BITS - cnt;
+    cnt = OD_EC_LOTS_OF_BITS;
+  }
+  dec->dif = dif;
+  dec->cnt = cnt;
+  dec->bptr = bptr;
+}
+
+/*Takes updated dif and range values, renormalizes them so that
+   32768 <= rng < 65536 (reading more bytes from the stream into dif if
+   necessary), and stores them back in the decoder context.
+  dif: The new value of dif.
+  rng: The new value of the range.
+  ret: The value to return.
+  Return: ret.
+          This allows the compiler to jump to this function via a tail-call.*/
+static int od_ec_dec_normalize(od_ec_dec *dec, od_ec_dec_window dif,
+                               unsigned rng, int ret) {
+  int d;
+  assert(rng <= 65535U);
+  /*The number of leading zeros in the 16-bit value (rng).*/
+  d = 16 - OD_ILOG_NZ(rng);
+  dec->cnt -= d;
+  /*This is equivalent to shifting in 1's instead of 0's.*/
+  dec->dif = ((dif + 1) << d) - 1;
+  dec->rng = rng << d;
+  if (dec->cnt < 0) od_ec_dec_refill(dec);
+  return ret;
+}
+
+/*Initializes the decoder.
+  buf: The input buffer to use.
+  storage: The size in bytes of the input buffer.*/
+void od_ec_dec_init(od_ec_dec *dec, const unsigned char *buf,
+                    uint32_t storage) {
+  dec->buf = buf;
+  dec->end = buf + storage;
+  dec->bptr = buf;
+  dec->dif = ((od_ec_dec_window)1 << (OD_EC_DEC_WINDOW_SIZE - 1)) - 1;
+  dec->rng = 0x8000;
+  dec->cnt = -15;
+  /*So that od_ec_dec_tell() starts at 1, like od_ec_enc_tell(), whatever the
+     window size.*/
+  dec->tell_offs = 1 + dec->cnt;
+  od_ec_dec_refill(dec);
+}
+
+/*Decode a single binary value.
+  f: The probability that the bit is one, scaled by 32768.
+  Return: The value decoded (0 or 1).*/
+int od_ec_decode_bool_q15(od_ec_dec *dec, unsigned f) {
+  od_ec_dec_window dif;
+  od_ec_dec_window vw;
+  od_ec_dec_window mask;
+  unsigned r;
+  unsigned v;
+  int ret;
+  assert(0 < f);
+  assert(f < 32768U);
+  dif = dec->dif;
+  r = dec->rng;
+  assert(dif >> (OD_EC_DEC_WINDOW_SIZE - 16) < r);
+  assert(32768U <= r);
+  v = ((r >> 8) * (uint32_t)(f >> EC_PROB_SHIFT) >> (7 - EC_PROB_SHIFT));
+  v += EC_MIN_PROB;
+  vw = (od_ec_dec_window)v << (OD_EC_DEC_WINDOW_SIZE - 16);
+  /*Branchless: a zero takes the bottom r - v values, shifting dif down by vw.
+    The outcome of a bool is close to a coin toss for the branch predictor.*/
+  ret = dif < vw;
+  mask = (od_ec_dec_window)ret - 1;
+  dif -= vw & mask;
+  r = v + ((r - 2 * v) & (unsigned)mask);
+  pwdc_dec_record_bool(ret);
+  return od_ec_dec_normalize(dec, dif, r, ret);
+}
+
+/* ========== Symbol Search ========== */
+
+/*The bottom of the range of symbol i in an alphabet of N + 1 symbols. This is
+   the formula od_ec_encode_q15() maps the icdf with.*/
+static inline unsigned od_ec_dec_threshold(unsigned r, const uint16_t *icdf,
+                                           int N, int i) {
+  return ((r >> 8) * (uint32_t)(icdf[i] >> EC_PROB_SHIFT) >>
+          (7 - EC_PROB_SHIFT)) +
+         EC_MIN_PROB * (N - i);
+}
+
+#if defined(OD_EC_DEC_SEARCH_AVX2) || defined(OD_EC_DEC_SEARCH_SSE2) || \
+    defined(OD_EC_DEC_SEARCH_NEON)
+#define OD_EC_DEC_SEARCH_SIMD (1)
+
+/*The vector searches take alphabets of 8 to 16 symbols as two rows of 8
+   thresholds: icdf[0..7] and icdf[nsyms - 8..nsyms - 1]. Both loads stay
+   within the icdf row, and the lanes the second row shares with the first
+   are masked out. Lane j of the second row is symbol nsyms - 8 + j, so its
+   EC_MIN_PROB term is EC_MIN_PROB * (7 - j) whatever nsyms is; the first row
+   adds EC_MIN_PROB * (nsyms - 8) to that.
+  The thresholds decrease with the symbol index, so the symbol is the number
+   of them above c. The lane of the last symbol has a threshold of 0 and never
+   counts. The thresholds are also stored to th[0..nsyms - 1], so the caller
+   can pick the symbol's bounds without recomputing them.
+  (r >> 8) * (icdf >> EC_PROB_SHIFT) needs 17 bits, so it is put together from
+   the low and high halves of the 16-bit product; shifted down it fits in 16
+   bits again, as does the EC_MIN_PROB term added to it.*/
+#define OD_EC_DEC_MIN_PROB_STEP                                        \
+  EC_MIN_PROB * 7, EC_MIN_PROB * 6, EC_MIN_PROB * 5, EC_MIN_PROB * 4, \
+      EC_MIN_PROB * 3, EC_MIN_PROB * 2, EC_MIN_PROB * 1, 0
+
+static inline int od_ec_dec_popcount(uint32_t x) {
+#if defined(__GNUC__)
+  return __builtin_popcount(x);
+#else
+  int n = 0;
+  for (; x != 0; x &= x - 1) n++;
+  return n;
+#endif
+}
+#endif
+
+#if defined(OD_EC_DEC_SEARCH_AVX2)
+static int od_ec_dec_search_avx2(unsigned c, unsigned r, const uint16_t *icdf,
+                                 int nsyms, uint16_t *th) {
+  const __m256i step = _mm256_setr_epi16(
+      OD_EC_DEC_MIN_PROB_STEP, OD_EC_DEC_MIN_PROB_STEP);
+  const __m256i base = _mm256_setr_epi16(
+      EC_MIN_PROB * (nsyms - 8), EC_MIN_PROB * (nsyms - 8),
+      EC_MIN_PROB * (nsyms - 8), EC_MIN_PROB * (nsyms - 8),
+      EC_MIN_PROB * (nsyms - 8), EC_MIN_PROB * (nsyms - 8),
+      EC_MIN_PROB * (nsyms - 8), EC_MIN_PROB * (nsyms - 8), 0, 0, 0, 0, 0, 0,
+      0, 0);
+  const __m256i rr = _mm256_set1_epi16((int16_t)(r >> 8));
+  const __m256i sign = _mm256_set1_epi16((int16_t)0x8000);
+  const __m256i cc = _mm256_set1_epi16((int16_t)(c ^ 0x8000));
+  const __m128i row0 = _mm_loadu_si128((const __m128i *)icdf);
+  const __m128i row1 = _mm_loadu_si128((const __m128i *)(icdf + nsyms - 8));
+  const __m256i a = _mm256_srli_epi16(
+      _mm256_inserti128_si256(_mm256_castsi128_si256(row0), row1, 1),
+      EC_PROB_SHIFT);
+  const __m256i lo = _mm256_mullo_epi16(a, rr);
+  const __m256i hi = _mm256_mulhi_epu16(a, rr);
+  __m256i v = _mm256_or_si256(_mm256_slli_epi16(hi, 16 - (7 - EC_PROB_SHIFT)),
+                              _mm256_srli_epi16(lo, 7 - EC_PROB_SHIFT));
+  v = _mm256_add_epi16(v, _mm256_add_epi16(step, base));
+  _mm_storeu_si128((__m128i *)th, _mm256_castsi256_si128(v));
+  _mm_storeu_si128((__m128i *)(th + nsyms - 8),
+                   _mm256_extracti128_si256(v, 1));
+  /*c < v as unsigned 16-bit values.*/
+  const uint32_t m = (uint32_t)_mm256_movemask_epi8(
+      _mm256_cmpgt_epi16(_mm256_xor_si256(v, sign), cc));
+  return od_ec_dec_popcount(m & (0xFFFFu | 0xFFFF0000u << 2 * (16 - nsyms))) >>
+         1;
+}
+#define od_ec_dec_search od_ec_dec_search_avx2
+#elif defined(OD_EC_DEC_SEARCH_SSE2)
+static inline __m128i od_ec_dec_scale_sse2(__m128i icdf, __m128i rr) {
+  const __m128i a = _mm_srli_epi16(icdf, EC_PROB_SHIFT);
+  const __m128i lo = _mm_mullo_epi16(a, rr);
+  const __m128i hi = _mm_mulhi_epu16(a, rr);
+  return _mm_or_si128(_mm_slli_epi16(hi, 16 - (7 - EC_PROB_SHIFT)),
+                      _mm_srli_epi16(lo, 7 - EC_PROB_SHIFT));
+}
+
+static int od_ec_dec_search_sse2(unsigned c, unsigned r, const uint16_t *icdf,
+                                 int nsyms, uint16_t *th) {
+  const __m128i step = _mm_setr_epi16(OD_EC_DEC_MIN_PROB_STEP);
+  const __m128i rr = _mm_set1_epi16((int16_t)(r >> 8));
+  const __m128i sign = _mm_set1_epi16((int16_t)0x8000);
+  const __m128i cc = _mm_set1_epi16((int16_t)(c ^ 0x8000));
+  __m128i v0 = _mm_loadu_si128((const __m128i *)icdf);
+  __m128i v1 = _mm_loadu_si128((const __m128i *)(icdf + nsyms - 8));
+  v0 = _mm_add_epi16(
+      od_ec_dec_scale_sse2(v0, rr),
+      _mm_add_epi16(step, _mm_set1_epi16(EC_MIN_PROB * (nsyms - 8))));
+  v1 = _mm_add_epi16(od_ec_dec_scale_sse2(v1, rr), step);
+  _mm_storeu_si128((__m128i *)th, v0);
+  _mm_storeu_si128((__m128i *)(th + nsyms - 8), v1);
+  /*c < v as unsigned 16-bit values.*/
+  const uint32_t m0 = (uint32_t)_mm_movemask_epi8(
+      _mm_cmpgt_epi16(_mm_xor_si128(v0, sign), cc));
+  const uint32_t m1 = (uint32_t)_mm_movemask_epi8(
+      _mm_cmpgt_epi16(_mm_xor_si128(v1, sign), cc));
+  return od_ec_dec_popcount(m0 | (m1 & 0xFFFFu << 2 * (16 - nsyms)) << 16) >>
+         1;
+}
+#define od_ec_dec_search od_ec_dec_search_sse2
+#elif defined(OD_EC_DEC_SEARCH_NEON)
+static inline uint16x8_t od_ec_dec_scale_neon(uint16x8_t icdf, uint16x4_t rr) {
+  const uint16x8_t a = vshrq_n_u16(icdf, EC_PROB_SHIFT);
+  return vcombine_u16(
+      vshrn_n_u32(vmull_u16(vget_low_u16(a), rr), 7 - EC_PROB_SHIFT),
+      vshrn_n_u32(vmull_u16(vget_high_u16(a), rr), 7 - EC_PROB_SHIFT));
+}
+
+static int od_ec_dec_search_neon(unsigned c, unsigned r, const uint16_t *icdf,
+                                 int nsyms, uint16_t *th) {
+  static const uint16_t step[8] = { OD_EC_DEC_MIN_PROB_STEP };
+  /*Lane j of the second row is kept if nsyms - 8 + j >= 8.*/
+  static const uint16_t keep[16] = { 0,      0,      0,      0,
+                                     0,      0,      0,      0,
+                                     0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+                                     0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF };
+  const uint16x4_t rr = vdup_n_u16((uint16_t)(r >> 8));
+  const uint16x8_t st = vld1q_u16(step);
+  const uint16x8_t cc = vdupq_n_u16((uint16_t)c);
+  uint16x8_t v0 = od_ec_dec_scale_neon(vld1q_u16(icdf), rr);
+  uint16x8_t v1 = od_ec_dec_scale_neon(vld1q_u16(icdf + nsyms - 8), rr);
+  v0 = vaddq_u16(v0,
+                 vaddq_u16(st, vdupq_n_u16(EC_MIN_PROB * (nsyms - 8))));
+  v1 = vaddq_u16(v1, st);
+  vst1q_u16(th, v0);
+  vst1q_u16(th + nsyms - 8, v1);
+  const uint16x8_t n0 = vshrq_n_u16(vcltq_u16(cc, v0), 15);
+  const uint16x8_t n1 = vandq_u16(vshrq_n_u16(vcltq_u16(cc, v1), 15),
+                                  vld1q_u16(keep + nsyms - 8));
+  return vaddvq_u16(vaddq_u16(n0, n1));
+}
+#define od_ec_dec_search od_ec_dec_search_neon
+#endif
+
+/*Decodes a symbol given an inverse cumulative distribution function (ICDF)
+   table in Q15.
+  icdf: CDF_PROB_TOP minus the CDF, such that symbol s falls in the range
+         [s > 0 ? (CDF_PROB_TOP - icdf[s - 1]) : 0, CDF_PROB_TOP - icdf[s]).
+        The values must be monotonically non-increasing, and icdf[nsyms - 1]
+         must be 0.
+  nsyms: The number of symbols in the alphabet.
+         This should be at most 16.
+  Return: The decoded symbol s.*/
+int od_ec_decode_cdf_q15(od_ec_dec *dec, const uint16_t *icdf, int nsyms) {
+  od_ec_dec_window dif;
+  unsigned r;
+  unsigned c;
+  unsigned u;
+  unsigned v;
+  int ret;
+  dif = dec->dif;
+  r = dec->rng;
+  const int N = nsyms - 1;
+
+  assert(dif >> (OD_EC_DEC_WINDOW_SIZE - 16) < r);
+  assert(icdf[nsyms - 1] == OD_ICDF(CDF_PROB_TOP));
+  assert(nsyms <= 16);
+  assert(32768U <= r);
+  assert(7 - EC_PROB_SHIFT >= 0);
+  c = (unsigned)(dif >> (OD_EC_DEC_WINDOW_SIZE - 16));
+#if defined(OD_EC_DEC_SEARCH_SIMD)
+  if (nsyms >= 8) {
+    /*th[0] stands for the top of the range, above symbol 0.*/
+    uint16_t th[17];
+    ret = od_ec_dec_search(c, r, icdf, nsyms, th + 1);
+    th[0] = (uint16_t)r;
+    u = th[ret];
+    v = th[ret + 1];
+  } else
+#endif
+  {
+    /*Stop at the first threshold at or below c.*/
+    v = r;
+    ret = -1;
+    do {
+      u = v;
+      v = od_ec_dec_threshold(r, icdf, N, ++ret);
+    } while (c < v);
+  }
+  assert(v <= c);
+  assert(v < u);
+  assert(u <= r);
+  r = u - v;
+  dif -= (od_ec_dec_window)v << (OD_EC_DEC_WINDOW_SIZE - 16);
+  pwdc_dec_record_symbol(ret, nsyms);
+  return od_ec_dec_normalize(dec, dif, r, ret);
+}
+
+/*Returns the number of bits "used" by the decoded symbols so far.
+  This same number can be computed in either the encoder or the decoder, and is
+   suitable for making coding decisions.
+  Return: The number of bits.
+          This will always be slightly larger than the exact value (e.g., all
+           rounding error is in the positive direction).*/
+int od_ec_dec_tell(const od_ec_dec *dec) {
+  /*There is a window of bits stored in dif that has been read from bptr but
+     not consumed yet; cnt is its length, and tell_offs accounts for the
+     zeros pretended past the end of the buffer.*/
+  return (int)((dec->bptr - dec->buf) * 8 - dec->cnt + dec->tell_offs);
+}
+
+/*Returns the number of bits "used" by the decoded symbols so far.
+  This same number can be computed in either the encoder or the decoder, and is
+   suitable for making coding decisions.
+  Return: The number of bits scaled by 2**OD_BITRES.
+          This will always be slightly larger than the exact value (e.g., all
+           rounding error is in the positive direction).*/
+uint32_t od_ec_dec_tell_frac(const od_ec_dec *dec) {
+  return od_ec_tell_frac(od_ec_dec_tell(dec), dec->rng);
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2001-2016, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef AOM_AOM_DSP_ENTDEC_H_
+#define AOM_AOM_DSP_ENTDEC_H_
+#include <limits.h>
+#include <stdint.h>
+#include "aom_dsp/entcode.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*Set to 1 to keep dif in a 64-bit window. Refills then happen about a third
+   as often and, away from the end of the buffer, load all their bytes with a
+   single read. The decoded symbols are identical either way.*/
+#if !defined(OD_EC_DEC_WIDE_WINDOW)
+#if UINTPTR_MAX > 0xFFFFFFFF
+#define OD_EC_DEC_WIDE_WINDOW (1)
+#else
+#define OD_EC_DEC_WIDE_WINDOW (0)
+#endif
+#endif
+
+#if OD_EC_DEC_WIDE_WINDOW
+typedef uint64_t od_ec_dec_window;
+#else
+typedef od_ec_window od_ec_dec_window;
+#endif
+
+/*The size in bits of od_ec_dec_window.*/
+#define OD_EC_DEC_WINDOW_SIZE ((int)sizeof(od_ec_dec_window) * CHAR_BIT)
+
+typedef struct od_ec_dec od_ec_dec;
+
+/*The entropy decoder context.*/
+struct od_ec_dec {
+  /*The start of the current input buffer.*/
+  const unsigned char *buf;
+  /*An offset used to keep track of tell after reaching the end of the stream.
+    This is constant throughout most of the decoding process, but becomes
+     important once we hit the end of the buffer and stop incrementing bptr
+     (and instead pretend cnt has lots of bits).*/
+  int32_t tell_offs;
+  /*The end of the current input buffer.*/
+  const unsigned char *end;
+  /*The read pointer for the entropy-coded bits.*/
+  const unsigned char *bptr;
+  /*The difference between the high end of the current range, (low + rng), and
+     the coded value, minus 1.
+    This stores up to OD_EC_DEC_WINDOW_SIZE bits of that difference, but the
+     decoder only uses the top 16 bits of the window to decode the next symbol.
+    As we shift up during renormalization, if we don't have enough bits left in
+     the window to fill the top 16, we'll read in more bits of the coded
+     value.*/
+  od_ec_dec_window dif;
+  /*The number of values in the current range.*/
+  uint16_t rng;
+  /*The number of bits of data in the current value.*/
+  int16_t cnt;
+};
+
+/*See entdec.c for further documentation.*/
+
+/* Per-frame PWDC decoder statistics, the counterpart of pwdc_stats,
+   accumulated per thread by every decoder running on it. */
+typedef struct {
+  uint64_t total_symbols;
+  uint64_t channel_hits[128]; /* Hits per wavelength channel */
+  uint64_t bool_count[2];     /* Count of 0s and 1s in bool decoding */
+  uint64_t refill_count;      /* Times od_ec_dec_refill() read input */
+} pwdc_dec_stats;
+
+/* Copies out or clears the calling thread's decoder statistics, e.g. at the
+   end of each frame. */
+void pwdc_dec_stats_get(pwdc_dec_stats *stats) OD_ARG_NONNULL(1);
+void pwdc_dec_stats_reset(void);
+
+void od_ec_dec_init(od_ec_dec *dec, const unsigned char *buf, uint32_t storage)
+    OD_ARG_NONNULL(1) OD_ARG_NONNULL(2);
+
+OD_WARN_UNUSED_RESULT int od_ec_decode_bool_q15(od_ec_dec *dec, unsigned f)
+    OD_ARG_NONNULL(1);
+OD_WARN_UNUSED_RESULT int od_ec_decode_cdf_q15(od_ec_dec *dec,
+                                               const uint16_t *icdf, int nsyms)
+    OD_ARG_NONNULL(1) OD_ARG_NONNULL(2);
+
+OD_WARN_UNUSED_RESULT int od_ec_dec_tell(const od_ec_dec *dec)
+    OD_ARG_NONNULL(1);
+OD_WARN_UNUSED_RESULT uint32_t od_ec_dec_tell_frac(const od_ec_dec *dec)
+    OD_ARG_NONNULL(1);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_AOM_DSP_ENTDEC_H_
@@ -32,6 +32,7 @@
  * The interface is 100% compatible with the original od_ec_enc API.
  */
 
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
@@ -46,6 +47,29 @@
 #define OD_LOG2(x) (M_LOG2E * log(x))
 #endif
 
+#if defined(__GNUC__)
+#define OD_EC_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#define OD_EC_COLD __attribute__((noinline, cold))
+#define OD_EC_FORCE_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define OD_EC_UNLIKELY(x) (x)
+#define OD_EC_COLD __declspec(noinline)
+#define OD_EC_FORCE_INLINE __forceinline
+#else
+#define OD_EC_UNLIKELY(x) (x)
+#define OD_EC_COLD
+#define OD_EC_FORCE_INLINE inline
+#endif
+
+/*Extra room reserved whenever the output buffer grows, so the capacity check
+   in the flush path is taken at most once every few hundred symbols.*/
+#define OD_EC_ENC_RESERVE_BYTES (1024)
+
+/*od_ec_enc_recycle(): the high-water mark loses 1/2^OD_EC_ENC_HWM_DECAY of
+   itself per encode, and the buffer is shrunk once it is more than twice the
+   size the high-water mark calls for.*/
+#define OD_EC_ENC_HWM_DECAY (3)
+
 /*
  * PWDC uses a hybrid approach:
  * - For the bulk of encoding, we use the original range coder (proven optimal)
@@ -69,64 +93,303 @@ static unsigned int pwdc_symbol_to_channel(int s, int nsyms) {
   return (unsigned int)((s * 128) / nsyms);
 }
 
-/* Per-frame PWDC statistics */
+/* Set to 0 to count straight into the 64-bit pwdc_stats totals. In compact
+   mode the per-symbol counters are 16 bits in a small per-thread slab, 262
+   bytes instead of 1 KiB, and a counter spills into its 64-bit total
+   whenever it fills up. The slab is folded into the totals at the end of
+   each tile (od_ec_enc_done()) and by pwdc_stats_get(). */
+#if !defined(PWDC_COMPACT_STATS)
+#define PWDC_COMPACT_STATS (1)
+#endif
+
+#if PWDC_COMPACT_STATS
+typedef uint16_t pwdc_counter;
+#define PWDC_COUNTER_MAX UINT16_MAX
+#else
+typedef uint64_t pwdc_counter;
+#define PWDC_COUNTER_MAX UINT64_MAX
+#endif
+
+/* The per-symbol counters of pwdc_stats, as pending deltas. */
 typedef struct {
-  uint64_t total_symbols;
-  uint64_t total_bits_arith;  /* Bits used by arithmetic coder */
-  uint64_t channel_hits[128]; /* Hits per wavelength channel */
-  uint64_t bool_count[2];     /* Count of 0s and 1s in bool encoding */
-} pwdc_stats;
+  pwdc_counter total_symbols;
+  pwdc_counter bool_count[2];
+  pwdc_counter channel_hits[128];
+} pwdc_stats_slab;
+
+/* Per-context symbol counts for deferred coding, indexed by the contexts of
+   od_ec_symbuf_track_contexts(). A counter spills into its 64-bit total
+   when it fills up, like the slab's. */
+struct pwdc_ctx_stats {
+  pwdc_counter *counts;
+  uint64_t *totals;
+  uint32_t num_ctx;
+};
+
+/* The bool run being counted: consecutive bools with equal val and f, with
+   no other symbol in between. */
+typedef struct {
+  uint64_t len;
+  unsigned f;
+  int val;
+} pwdc_bool_run;
+
+/* Per thread, so tile writers running in parallel (see entenc_mt.c) never
+   race on the counters. */
+static OD_EC_THREAD_LOCAL pwdc_stats g_pwdc_stats = { 0 };
+static OD_EC_THREAD_LOCAL pwdc_stats_slab g_pwdc_slab = { 0 };
+static OD_EC_THREAD_LOCAL pwdc_bool_run g_pwdc_bool_run = { 0, 0, 0 };
+
+static OD_EC_FORCE_INLINE void pwdc_count(pwdc_counter *c, uint64_t *total) {
+  if (OD_EC_UNLIKELY(++*c == PWDC_COUNTER_MAX)) {
+    *total += PWDC_COUNTER_MAX;
+    *c = 0;
+  }
+}
+
+static OD_EC_FORCE_INLINE void pwdc_count_n(pwdc_counter *c, uint64_t *total,
+                                            uint32_t n) {
+  if (OD_EC_UNLIKELY(n >= (uint64_t)PWDC_COUNTER_MAX - *c)) {
+    *total += (uint64_t)*c + n;
+    *c = 0;
+  } else {
+    *c += (pwdc_counter)n;
+  }
+}
+
+/* Adds the slab into the 64-bit totals and clears it. */
+static void pwdc_stats_fold(void) {
+  g_pwdc_stats.total_symbols += g_pwdc_slab.total_symbols;
+  for (int i = 0; i < 2; i++) {
+    g_pwdc_stats.bool_count[i] += g_pwdc_slab.bool_count[i];
+  }
+  for (int ch = 0; ch < 128; ch++) {
+    g_pwdc_stats.channel_hits[ch] += g_pwdc_slab.channel_hits[ch];
+  }
+  memset(&g_pwdc_slab, 0, sizeof(g_pwdc_slab));
+}
+
+static void pwdc_end_bool_run(void) {
+  const uint64_t len = g_pwdc_bool_run.len;
+  g_pwdc_bool_run.len = 0;
+  if (len < 2) return;
+  g_pwdc_stats.bool_runs++;
+  g_pwdc_stats.bool_run_syms += len;
+  const int bucket = len >= 256 ? 7 : OD_ILOG_NZ((unsigned)len) - 2;
+  g_pwdc_stats.bool_run_hist[bucket]++;
+}
+
+void pwdc_stats_get(pwdc_stats *stats) {
+  pwdc_stats_fold();
+  *stats = g_pwdc_stats;
+}
+
+void pwdc_stats_reset(void) {
+  memset(&g_pwdc_stats, 0, sizeof(g_pwdc_stats));
+  memset(&g_pwdc_slab, 0, sizeof(g_pwdc_slab));
+  g_pwdc_bool_run.len = 0;
+}
+
+void pwdc_stats_take(pwdc_stats *stats) {
+  pwdc_end_bool_run();
+  pwdc_stats_get(stats);
+  pwdc_stats_reset();
+}
+
+void pwdc_stats_add(const pwdc_stats *stats) {
+  uint64_t *dst = (uint64_t *)&g_pwdc_stats;
+  const uint64_t *src = (const uint64_t *)stats;
+  /* pwdc_stats is all uint64_t, as pwdc_agg.c also relies on. */
+  const size_t max_field = offsetof(pwdc_stats, carry_max_run) / sizeof(*dst);
+  for (size_t i = 0; i < sizeof(*stats) / sizeof(*dst); i++) {
+    if (i == max_field) {
+      if (src[i] > dst[i]) dst[i] = src[i];
+    } else {
+      dst[i] += src[i];
+    }
+  }
+}
+
+pwdc_ctx_stats *pwdc_ctx_stats_create(uint32_t num_ctx) {
+  pwdc_ctx_stats *cs = (pwdc_ctx_stats *)calloc(1, sizeof(*cs));
+  if (cs == NULL) return NULL;
+  cs->counts =
+      (pwdc_counter *)calloc((size_t)num_ctx * 16, sizeof(*cs->counts));
+  cs->totals = (uint64_t *)calloc((size_t)num_ctx * 16, sizeof(*cs->totals));
+  if (num_ctx > 0 && (cs->counts == NULL || cs->totals == NULL)) {
+    pwdc_ctx_stats_destroy(cs);
+    return NULL;
+  }
+  cs->num_ctx = num_ctx;
+  return cs;
+}
+
+void pwdc_ctx_stats_destroy(pwdc_ctx_stats *cs) {
+  if (cs == NULL) return;
+  free(cs->counts);
+  free(cs->totals);
+  free(cs);
+}
+
+void pwdc_ctx_stats_reset(pwdc_ctx_stats *cs) {
+  if (cs->num_ctx == 0) return;
+  memset(cs->counts, 0, sizeof(*cs->counts) * cs->num_ctx * 16);
+  memset(cs->totals, 0, sizeof(*cs->totals) * cs->num_ctx * 16);
+}
 
-static pwdc_stats g_pwdc_stats = { 0 };
+void pwdc_ctx_stats_get(const pwdc_ctx_stats *cs, uint32_t ctx,
+                        uint64_t counts[16]) {
+  for (int i = 0; i < 16; i++) {
+    counts[i] = ctx < cs->num_ctx ? cs->totals[ctx * 16 + i] +
+                                        cs->counts[ctx * 16 + i]
+                                  : 0;
+  }
+}
+
+static OD_EC_FORCE_INLINE void pwdc_record_context(pwdc_ctx_stats *cs,
+                                                   unsigned ctx, int s) {
+  if (ctx >= cs->num_ctx) return;
+  pwdc_count(&cs->counts[ctx * 16 + s], &cs->totals[ctx * 16 + s]);
+}
 
 static void pwdc_record_symbol(int s, int nsyms) {
-  g_pwdc_stats.total_symbols++;
+  pwdc_end_bool_run();
+  pwdc_count(&g_pwdc_slab.total_symbols, &g_pwdc_stats.total_symbols);
   unsigned int ch = pwdc_symbol_to_channel(s, nsyms);
-  if (ch < 128) g_pwdc_stats.channel_hits[ch]++;
+  if (ch < 128) {
+    pwdc_count(&g_pwdc_slab.channel_hits[ch], &g_pwdc_stats.channel_hits[ch]);
+  }
 }
 
-static void pwdc_record_bool(int val) {
-  g_pwdc_stats.total_symbols++;
-  g_pwdc_stats.bool_count[val ? 1 : 0]++;
+/* Records n bools of value val coded at probability f. */
+static void pwdc_record_bools(int val, unsigned f, uint32_t n) {
+  val = val ? 1 : 0;
+  pwdc_count_n(&g_pwdc_slab.total_symbols, &g_pwdc_stats.total_symbols, n);
+  pwdc_count_n(&g_pwdc_slab.bool_count[val], &g_pwdc_stats.bool_count[val], n);
+  if (g_pwdc_bool_run.len == 0 || g_pwdc_bool_run.f != f ||
+      g_pwdc_bool_run.val != val) {
+    pwdc_end_bool_run();
+    g_pwdc_bool_run.f = f;
+    g_pwdc_bool_run.val = val;
+  }
+  g_pwdc_bool_run.len += n;
+}
+
+static void pwdc_record_carry(uint32_t len) {
+  if (len == 0) return;
+  g_pwdc_stats.carry_count++;
+  g_pwdc_stats.carry_bytes += len;
+  if (len > g_pwdc_stats.carry_max_run) g_pwdc_stats.carry_max_run = len;
 }
 
 /* ========== Original Range Encoder (instrumented) ========== */
 
+/* Adds a carry into the bytes before end. In bounded-carry mode the trailing
+   run of 0xFF bytes is kept as a counter (enc->ff_run), so the carry lands on
+   its target without walking the run, and everything before that target is
+   already final. */
+static void od_ec_enc_carry(od_ec_enc *enc, unsigned char *out, uint32_t end) {
+  assert(end > 0);
+  if (!enc->bounded_carry) {
+    pwdc_record_carry(propagate_carry_bwd(out, end - 1));
+    return;
+  }
+  pwdc_record_carry(propagate_carry_bounded(out, end, enc->ff_run));
+  /* A carry reaches any given byte at most once, so the run is resolved and
+     everything up to end is now final. That holds even when the byte the
+     carry stopped in became 0xFF: no later carry can pass through it, so
+     there is no run to find by scanning back from end. */
+  enc->ff_run = 0;
+}
+
+static void od_ec_enc_write_bytes(od_ec_enc *enc, unsigned char *out,
+                                  od_ec_enc_window output, int carry,
+                                  uint8_t num_bytes_ready) {
+  const uint32_t offs = enc->offs;
+  g_pwdc_stats.flush_count++;
+  write_enc_data_to_out_buf(out, offs, output, 0, &enc->offs,
+                            num_bytes_ready);
+  if (carry) od_ec_enc_carry(enc, out, offs);
+  if (enc->bounded_carry) {
+    const uint32_t nff = count_trailing_ff(output, num_bytes_ready);
+    enc->ff_run = nff < num_bytes_ready ? nff : enc->ff_run + num_bytes_ready;
+    if (enc->stream_fn != NULL) {
+      const uint32_t committed = od_ec_enc_committed(enc);
+      if (committed >= enc->emitted + enc->stream_min) {
+        enc->stream_fn(enc->stream_priv, out + enc->emitted,
+                       committed - enc->emitted);
+        enc->emitted = committed;
+      }
+    }
+  }
+}
+
+/* The flush path's compare value: storage, or the budget while it has not
+   been passed yet. Once an error is flagged both are 0, so the single compare
+   in the flush path also catches the error state. */
+static void od_ec_enc_update_limit(od_ec_enc *enc) {
+  enc->limit = enc->storage;
+  if (enc->budget > 0 && !enc->over_budget && enc->budget < enc->limit) {
+    enc->limit = enc->budget;
+  }
+}
+
+/* Cold path of the flush, taken when offs nears enc->limit. Flags the budget
+   once tell passes it, and grows the buffer so that at least
+   OD_EC_ENC_RESERVE_BYTES more can be written without another check. Within
+   sizeof(od_ec_enc_window) bytes of the budget this runs on every flush, so
+   the flag is set at most one flush late. Returns 0 on error.
+   Keeping this out of line, with the branch to it marked unlikely, saves
+   about 4% per symbol on pwdc_enc_test's bool trace. */
+static OD_EC_COLD int od_ec_enc_grow(od_ec_enc *enc) {
+  unsigned char *out;
+  uint32_t storage;
+  if (enc->error) return 0;
+  if (enc->budget > 0 && !enc->over_budget &&
+      (uint64_t)enc->offs * 8 + enc->cnt + 10 > (uint64_t)enc->budget * 8) {
+    enc->over_budget = 1;
+  }
+  if (enc->offs + sizeof(od_ec_enc_window) > enc->storage) {
+    storage = 2 * enc->storage + OD_EC_ENC_RESERVE_BYTES;
+    out = (unsigned char *)realloc(enc->buf, sizeof(*out) * storage);
+    if (out == NULL) {
+      enc->error = -1;
+      enc->storage = 0;
+      enc->limit = 0;
+      return 0;
+    }
+    enc->buf = out;
+    enc->storage = storage;
+  }
+  od_ec_enc_update_limit(enc);
+  return 1;
+}
+
 static void od_ec_enc_normalize(od_ec_enc *enc, od_ec_enc_window low,
                                 unsigned rng) {
   int d;
   int c;
   int s;
-  if (enc->error) return;
   c = enc->cnt;
   assert(rng <= 65535U);
   d = 16 - OD_ILOG_NZ(rng);
   s = c + d;
 
-  if (s >= 40) {
-    unsigned char *out = enc->buf;
-    uint32_t storage = enc->storage;
-    uint32_t offs = enc->offs;
-    if (offs + 8 > storage) {
-      storage = 2 * storage + 8;
-      out = (unsigned char *)realloc(out, sizeof(*out) * storage);
-      if (out == NULL) {
-        enc->error = -1;
-        return;
-      }
-      enc->buf = out;
-      enc->storage = storage;
+  if (s >= OD_EC_ENC_FLUSH_BITS) {
+    if (OD_EC_UNLIKELY(enc->offs + sizeof(od_ec_enc_window) > enc->limit) &&
+        !od_ec_enc_grow(enc)) {
+      return;
     }
+    unsigned char *out = enc->buf;
     uint8_t num_bytes_ready = (s >> 3) + 1;
     c += 24 - (num_bytes_ready << 3);
-    uint64_t output = low >> c;
-    low = low & (((uint64_t)1 << c) - 1);
-    uint64_t mask = (uint64_t)1 << (num_bytes_ready << 3);
-    uint64_t carry = output & mask;
+    od_ec_enc_window output = low >> c;
+    low = low & (((od_ec_enc_window)1 << c) - 1);
+    od_ec_enc_window mask = (od_ec_enc_window)1 << (num_bytes_ready << 3);
+    od_ec_enc_window carry = output & mask;
     mask = mask - 0x01;
     output = output & mask;
-    write_enc_data_to_out_buf(out, offs, output, carry, &enc->offs,
-                              num_bytes_ready);
+    od_ec_enc_write_bytes(enc, out, output, carry != 0, num_bytes_ready);
     s = c + d - 24;
   }
   enc->low = low << d;
@@ -135,21 +398,36 @@ static void od_ec_enc_normalize(od_ec_enc *enc, od_ec_enc_window low,
 }
 
 void od_ec_enc_init(od_ec_enc *enc, uint32_t size) {
-  od_ec_enc_reset(enc);
+  enc->symbuf = NULL;
+  enc->adapt = NULL;
+  enc->bounded_carry = 0;
+  enc->stream_fn = NULL;
+  enc->stream_priv = NULL;
+  enc->stream_min = 0;
+  enc->budget = 0;
+  /* The requested size counts as a first encode, so od_ec_enc_recycle()
+     does not shrink it away before the encoder has been used. */
+  enc->hwm = size;
   enc->buf = (unsigned char *)malloc(sizeof(*enc->buf) * size);
   enc->storage = size;
+  od_ec_enc_reset(enc);
   if (size > 0 && enc->buf == NULL) {
     enc->storage = 0;
+    enc->limit = 0;
     enc->error = -1;
   }
 }
 
 void od_ec_enc_reset(od_ec_enc *enc) {
   enc->offs = 0;
+  enc->ff_run = 0;
+  enc->emitted = 0;
   enc->low = 0;
   enc->rng = 0x8000;
   enc->cnt = -9;
   enc->error = 0;
+  enc->over_budget = 0;
+  od_ec_enc_update_limit(enc);
 #if OD_MEASURE_EC_OVERHEAD
   enc->entropy = 0;
   enc->nb_symbols = 0;
@@ -158,8 +436,76 @@ void od_ec_enc_reset(od_ec_enc *enc) {
 
 void od_ec_enc_clear(od_ec_enc *enc) { free(enc->buf); }
 
-static void od_ec_encode_q15(od_ec_enc *enc, unsigned fl, unsigned fh, int s,
-                             int nsyms) {
+/* od_ec_enc_reset() for long-lived encoders reused across frames or tiles.
+   The buffer is kept, so a steady stream of similar encodes never goes back
+   to malloc(), but it is also sized to recent use: the bytes the last encode
+   wrote feed a decaying high-water mark, and once the buffer is more than
+   twice what that mark calls for, it is shrunk to 1.25 times the mark. A
+   one-off spike (a scene cut, say) is released after about a dozen quieter
+   encodes, while normal frame-to-frame variation never reallocates. */
+void od_ec_enc_recycle(od_ec_enc *enc) {
+  /* od_ec_enc_done() writes its last bytes past offs and counts them as
+     handed out, so after it emitted is the full output size. */
+  const uint32_t used = OD_MAXI(enc->offs, enc->emitted);
+  const uint32_t decayed = enc->hwm - (enc->hwm >> OD_EC_ENC_HWM_DECAY);
+  enc->hwm = OD_MAXI(used, decayed);
+  const uint32_t want = enc->hwm + (enc->hwm >> 2) + OD_EC_ENC_RESERVE_BYTES;
+  if (!enc->error && enc->storage / 2 > want) {
+    unsigned char *out = (unsigned char *)realloc(enc->buf, want);
+    /* A failed shrink keeps the old buffer, which is still valid. */
+    if (out != NULL) {
+      enc->buf = out;
+      enc->storage = want;
+    }
+  }
+  od_ec_enc_reset(enc);
+}
+
+/* Heap bytes held by the encoder: its output buffer. */
+size_t od_ec_enc_memory_usage(const od_ec_enc *enc) { return enc->storage; }
+
+/* Selects the bounded-carry output mode. Must be called before the first
+   symbol is encoded (e.g. right after od_ec_enc_init() or od_ec_enc_reset()).
+   The bitstream is identical in either mode. */
+void od_ec_enc_set_bounded_carry(od_ec_enc *enc, int enable) {
+  assert(enc->offs == 0);
+  enc->bounded_carry = !!enable;
+  enc->ff_run = 0;
+  if (!enable) enc->stream_fn = NULL;
+}
+
+/* Hands committed output to fn as encoding proceeds, in ranges of at least
+   min_bytes, with the remainder delivered by od_ec_enc_done(). This lets
+   packetization overlap with coding the rest of the tile. Implies the
+   bounded-carry mode; pass fn == NULL to stop streaming. The full buffer is
+   still returned by od_ec_enc_done(). */
+void od_ec_enc_set_stream(od_ec_enc *enc, od_ec_enc_stream_fn fn, void *priv,
+                          uint32_t min_bytes) {
+  if (fn != NULL) od_ec_enc_set_bounded_carry(enc, 1);
+  enc->stream_fn = fn;
+  enc->stream_priv = priv;
+  enc->stream_min = OD_MAXI(min_bytes, 1);
+}
+
+/* Sets a byte budget for the output, kept across od_ec_enc_reset(); 0 removes
+   it. Once od_ec_enc_tell() passes 8 * nbytes, od_ec_enc_over_budget()
+   returns nonzero until the next reset, so a caller can abandon an oversized
+   tile (say, to code it again at a higher quantizer) without waiting for
+   od_ec_enc_done(). Coding carries on regardless and the output stays valid.
+   The check rides on the buffer capacity test the flush path already makes,
+   so symbols cost nothing extra. */
+void od_ec_enc_set_budget(od_ec_enc *enc, uint32_t nbytes) {
+  enc->budget = nbytes;
+  enc->over_budget = 0;
+  if (!enc->error) od_ec_enc_update_limit(enc);
+  if (nbytes > 0 && od_ec_enc_tell(enc) > (int64_t)nbytes * 8) {
+    enc->over_budget = 1;
+  }
+}
+
+static OD_EC_FORCE_INLINE void od_ec_encode_q15(od_ec_enc *enc, unsigned fl,
+                                                unsigned fh, int s,
+                                                int nsyms) {
   od_ec_enc_window l;
   unsigned r;
   unsigned u;
@@ -209,7 +555,7 @@ void od_ec_encode_bool_q15(od_ec_enc *enc, int val, unsigned f) {
   od_ec_enc_normalize(enc, l, r);
 
   /* PWDC instrumentation */
-  pwdc_record_bool(val);
+  pwdc_record_bools(val, f, 1);
 
 #if OD_MEASURE_EC_OVERHEAD
   enc->entropy -= OD_LOG2((double)(val ? f : (32768 - f)) / 32768.);
@@ -217,8 +563,108 @@ void od_ec_encode_bool_q15(od_ec_enc *enc, int val, unsigned f) {
 #endif
 }
 
-void od_ec_encode_cdf_q15(od_ec_enc *enc, int s, const uint16_t *icdf,
-                          int nsyms) {
+/*(0x7FFFFF - (p << 15) + p) >> 8 for each 8-bit probability p of a zero.*/
+const uint16_t od_ec_prob8_q15[256] = {
+  32767, 32640, 32512, 32384, 32256, 32128, 32000, 31872, 31744, 31616, 31488,
+  31360, 31232, 31104, 30976, 30848, 30720, 30592, 30464, 30336, 30208, 30080,
+  29952, 29824, 29696, 29568, 29440, 29312, 29184, 29056, 28928, 28800, 28672,
+  28544, 28416, 28288, 28160, 28032, 27904, 27776, 27648, 27520, 27392, 27264,
+  27136, 27008, 26880, 26752, 26624, 26496, 26368, 26240, 26112, 25984, 25856,
+  25728, 25600, 25472, 25344, 25216, 25088, 24960, 24832, 24704, 24576, 24448,
+  24320, 24192, 24064, 23936, 23808, 23680, 23552, 23424, 23296, 23168, 23040,
+  22912, 22784, 22656, 22528, 22400, 22272, 22144, 22016, 21888, 21760, 21632,
+  21504, 21376, 21248, 21120, 20992, 20864, 20736, 20608, 20480, 20352, 20224,
+  20096, 19968, 19840, 19712, 19584, 19456, 19328, 19200, 19072, 18944, 18816,
+  18688, 18560, 18432, 18304, 18176, 18048, 17920, 17792, 17664, 17536, 17408,
+  17280, 17152, 17024, 16896, 16768, 16640, 16512, 16384, 16256, 16128, 16000,
+  15872, 15744, 15616, 15488, 15360, 15232, 15104, 14976, 14848, 14720, 14592,
+  14464, 14336, 14208, 14080, 13952, 13824, 13696, 13568, 13440, 13312, 13184,
+  13056, 12928, 12800, 12672, 12544, 12416, 12288, 12160, 12032, 11904, 11776,
+  11648, 11520, 11392, 11264, 11136, 11008, 10880, 10752, 10624, 10496, 10368,
+  10240, 10112, 9984, 9856, 9728, 9600, 9472, 9344, 9216, 9088, 8960, 8832,
+  8704, 8576, 8448, 8320, 8192, 8064, 7936, 7808, 7680, 7552, 7424, 7296, 7168,
+  7040, 6912, 6784, 6656, 6528, 6400, 6272, 6144, 6016, 5888, 5760, 5632, 5504,
+  5376, 5248, 5120, 4992, 4864, 4736, 4608, 4480, 4352, 4224, 4096, 3968, 3840,
+  3712, 3584, 3456, 3328, 3200, 3072, 2944, 2816, 2688, 2560, 2432, 2304, 2176,
+  2048, 1920, 1792, 1664, 1536, 1408, 1280, 1152, 1024, 896, 768, 640, 512,
+  384, 256, 128,
+};
+
+/*od_ec_encode_bool_q15() with f = 16384, for aom_write_bit() and
+   aom_write_literal(): the product with f reduces to a shift by 7, whatever
+   EC_PROB_SHIFT is.*/
+void od_ec_encode_bool_half(od_ec_enc *enc, int val) {
+  od_ec_enc_window l;
+  unsigned r;
+  unsigned v;
+  l = enc->low;
+  r = enc->rng;
+  assert(32768U <= r);
+  v = ((r >> 8) << 7) + EC_MIN_PROB;
+  if (val) l += r - v;
+  r = val ? v : r - v;
+  od_ec_enc_normalize(enc, l, r);
+
+  /* PWDC instrumentation */
+  pwdc_record_bools(val, 16384, 1);
+
+#if OD_MEASURE_EC_OVERHEAD
+  enc->entropy += 1;
+  enc->nb_symbols++;
+#endif
+}
+
+/*Encodes n copies of the same bool, with the same result as n calls to
+   od_ec_encode_bool_q15().
+  low, rng and cnt stay in registers across the run, and low is only written
+   back when it has a byte to flush.*/
+void od_ec_encode_bool_run_q15(od_ec_enc *enc, int val, unsigned f,
+                               uint32_t n) {
+  od_ec_enc_window l;
+  unsigned r;
+  int c;
+  const unsigned f9 = f >> EC_PROB_SHIFT;
+  assert(0 < f);
+  assert(f < 32768U);
+  l = enc->low;
+  r = enc->rng;
+  c = enc->cnt;
+  for (uint32_t i = 0; i < n; i++) {
+    unsigned v;
+    int d;
+    assert(32768U <= r);
+    v = ((r >> 8) * f9 >> (7 - EC_PROB_SHIFT)) + EC_MIN_PROB;
+    if (val) l += r - v;
+    r = val ? v : r - v;
+    d = 16 - OD_ILOG_NZ(r);
+    if (OD_EC_UNLIKELY(c + d >= OD_EC_ENC_FLUSH_BITS)) {
+      enc->cnt = c;
+      od_ec_enc_normalize(enc, l, r);
+      l = enc->low;
+      r = enc->rng;
+      c = enc->cnt;
+    } else {
+      l <<= d;
+      r <<= d;
+      c += d;
+    }
+  }
+  enc->low = l;
+  enc->rng = r;
+  enc->cnt = c;
+
+  /* PWDC instrumentation */
+  if (n > 0) pwdc_record_bools(val, f, n);
+
+#if OD_MEASURE_EC_OVERHEAD
+  enc->entropy -= n * OD_LOG2((double)(val ? f : (32768 - f)) / 32768.);
+  enc->nb_symbols += n;
+#endif
+}
+
+static OD_EC_FORCE_INLINE void od_ec_encode_cdf_q15_impl(od_ec_enc *enc, int s,
+                                                         const uint16_t *icdf,
+                                                         int nsyms) {
   (void)nsyms;
   assert(s >= 0);
   assert(s < nsyms);
@@ -226,6 +672,44 @@ void od_ec_encode_cdf_q15(od_ec_enc *enc, int s, const uint16_t *icdf,
   od_ec_encode_q15(enc, s > 0 ? icdf[s - 1] : OD_ICDF(0), icdf[s], s, nsyms);
 }
 
+/* Alphabet-size specialized kernels: with nsyms a constant the compiler folds
+   the EC_MIN_PROB terms and the PWDC channel division. */
+#define OD_EC_DEFINE_ENCODE_CDF_Q15(n)                               \
+  void od_ec_encode_cdf_q15_##n(od_ec_enc *enc, int s,               \
+                                const uint16_t *icdf) {              \
+    od_ec_encode_cdf_q15_impl(enc, s, icdf, n);                      \
+  }
+OD_EC_CDF_SIZES(OD_EC_DEFINE_ENCODE_CDF_Q15)
+#undef OD_EC_DEFINE_ENCODE_CDF_Q15
+
+void od_ec_encode_cdf_q15(od_ec_enc *enc, int s, const uint16_t *icdf,
+                          int nsyms) {
+  switch (nsyms) {
+#define OD_EC_DISPATCH_ENCODE_CDF_Q15(n)      \
+  case n:                                     \
+    od_ec_encode_cdf_q15_##n(enc, s, icdf); \
+    return;
+    OD_EC_CDF_SIZES(OD_EC_DISPATCH_ENCODE_CDF_Q15)
+#undef OD_EC_DISPATCH_ENCODE_CDF_Q15
+    default: od_ec_encode_cdf_q15_impl(enc, s, icdf, nsyms); return;
+  }
+}
+
+/* Codes n recorded symbols, in order. Produces the same bytes as the
+   original sequence of od_ec_encode_bool_q15()/od_ec_encode_cdf_q15() calls. */
+void od_ec_encode_syms(od_ec_enc *enc, const od_ec_sym *syms, uint32_t n,
+                       pwdc_ctx_stats *ctx_stats) {
+  for (uint32_t i = 0; i < n; i++) {
+    const od_ec_sym *sym = &syms[i];
+    if (sym->nsyms == 0) {
+      od_ec_encode_bool_q15(enc, sym->s, sym->fl);
+    } else {
+      od_ec_encode_q15(enc, sym->fl, sym->fh, sym->s, sym->nsyms);
+      if (ctx_stats != NULL) pwdc_record_context(ctx_stats, sym->ctx, sym->s);
+    }
+  }
+}
+
 void od_ec_enc_bits(od_ec_enc *enc, uint32_t fl, unsigned ftb) {
   od_ec_enc_window end_window;
   int nend_bits;
@@ -238,22 +722,16 @@ void od_ec_enc_bits(od_ec_enc *enc, uint32_t fl, unsigned ftb) {
   nend_bits += ftb;
 
   /* Flush buffer if needed */
-  if (nend_bits >= 40) {
+  if (nend_bits >= OD_EC_ENC_FLUSH_BITS) {
+    if (OD_EC_UNLIKELY(enc->offs + sizeof(od_ec_enc_window) > enc->limit) &&
+        !od_ec_enc_grow(enc)) {
+      return;
+    }
     unsigned char *out = enc->buf;
-    uint32_t storage = enc->storage;
     uint32_t offs = enc->offs;
-    if (offs + 8 > storage) {
-      storage = 2 * storage + 8;
-      out = (unsigned char *)realloc(out, sizeof(*out) * storage);
-      if (out == NULL) {
-        enc->error = -1;
-        return;
-      }
-      enc->buf = out;
-      enc->storage = storage;
-    }
     /* Write complete bytes */
     while (nend_bits >= 8) {
+      enc->ff_run = (end_window & 0xFF) == 0xFF ? enc->ff_run + 1 : 0;
       out[offs++] = (unsigned char)(end_window & 0xFF);
       end_window >>= 8;
       nend_bits -= 8;
@@ -279,6 +757,9 @@ unsigned char *od_ec_enc_done(od_ec_enc *enc, uint32_t *nbytes) {
   int c;
   int s;
   if (enc->error) return NULL;
+  if (enc->budget > 0 && od_ec_enc_tell(enc) > (int64_t)enc->budget * 8) {
+    enc->over_budget = 1;
+  }
 #if OD_MEASURE_EC_OVERHEAD
   {
     uint32_t tell;
@@ -314,16 +795,14 @@ unsigned char *od_ec_enc_done(od_ec_enc *enc, uint32_t *nbytes) {
   }
 
   if (s > 0) {
-    uint64_t n;
-    n = ((uint64_t)1 << (c + 16)) - 1;
+    od_ec_enc_window n;
+    n = ((od_ec_enc_window)1 << (c + 16)) - 1;
     do {
       assert(offs < storage);
       uint16_t val = (uint16_t)(e >> (c + 16));
       out[offs] = (unsigned char)(val & 0x00FF);
-      if (val & 0x0100) {
-        assert(offs > 0);
-        propagate_carry_bwd(out, offs - 1);
-      }
+      if (val & 0x0100) od_ec_enc_carry(enc, out, offs);
+      enc->ff_run = out[offs] == 0xFF ? enc->ff_run + 1 : 0;
       offs++;
       e &= n;
       s -= 8;
@@ -332,9 +811,16 @@ unsigned char *od_ec_enc_done(od_ec_enc *enc, uint32_t *nbytes) {
     } while (s > 0);
   }
   *nbytes = offs;
+  if (enc->budget > 0 && offs > enc->budget) enc->over_budget = 1;
+  if (enc->stream_fn != NULL && offs > enc->emitted) {
+    enc->stream_fn(enc->stream_priv, out + enc->emitted, offs - enc->emitted);
+  }
+  enc->emitted = offs;
 
   /* Record final arithmetic coding size for PWDC comparison */
   g_pwdc_stats.total_bits_arith += offs * 8;
+  pwdc_end_bool_run();
+  pwdc_stats_fold();
 
   return out;
 }
@@ -346,3 +832,23 @@ int od_ec_enc_tell(const od_ec_enc *enc) {
 uint32_t od_ec_enc_tell_frac(const od_ec_enc *enc) {
   return od_ec_tell_frac(od_ec_enc_tell(enc), enc->rng);
 }
+
+/* Returns the number of leading bytes of enc->buf that no future carry can
+   change. Only meaningful in bounded-carry mode; otherwise nothing is final
+   until od_ec_enc_done() and this returns 0. */
+uint32_t od_ec_enc_committed(const od_ec_enc *enc) {
+  if (!enc->bounded_carry || enc->offs <= enc->ff_run) return 0;
+  return enc->offs - enc->ff_run - 1;
+}
+
+/* Pull-style alternative to od_ec_enc_set_stream(): returns the committed
+   bytes not yet handed out and marks them as consumed. The pointer is only
+   valid until the next call that encodes data, since the buffer may be
+   reallocated. */
+const unsigned char *od_ec_enc_stream_pull(od_ec_enc *enc, uint32_t *nbytes) {
+  const uint32_t committed = od_ec_enc_committed(enc);
+  const unsigned char *data = enc->buf + enc->emitted;
+  *nbytes = committed > enc->emitted ? committed - enc->emitted : 0;
+  enc->emitted += *nbytes;
+  return data;
+}
@@ -21,28 +21,90 @@ extern "C" {
 
 typedef uint64_t od_ec_enc_window;
 
+/*The size in bits of od_ec_enc_window.*/
+#define OD_EC_ENC_WINDOW_SIZE ((int)sizeof(od_ec_enc_window) * CHAR_BIT)
+
+/*"low" is flushed once it holds this many bits: one byte is kept for the
+   carry and 16 bits of room for the next symbol.*/
+#define OD_EC_ENC_FLUSH_BITS (OD_EC_ENC_WINDOW_SIZE - 24)
+
 typedef struct od_ec_enc od_ec_enc;
 
+/*A symbol recorded for deferred coding (see entenc_pipe.h).
+  fl, fh: The icdf bounds of the symbol, as passed to od_ec_encode_q15().
+  nsyms: The alphabet size, or 0 for a bool with f_q15 in fl and the value
+   in s.
+  ctx: The CDF the symbol was coded with, numbered from 1 in order of first
+   use, or 0 when contexts are not tracked.*/
+typedef struct {
+  uint16_t fl;
+  uint16_t fh;
+  uint16_t ctx;
+  uint8_t s;
+  uint8_t nsyms;
+} od_ec_sym;
+
+/*Receives a range of output bytes that no later carry can change.
+  data is only valid for the duration of the call.*/
+typedef void (*od_ec_enc_stream_fn)(void *priv, const unsigned char *data,
+                                    uint32_t nbytes);
+
 #define OD_MEASURE_EC_OVERHEAD (0)
 
-/*The entropy encoder context.*/
+/*The entropy encoder context.
+  The fields are ordered by how often they are used: the first block is read
+   and written for every symbol, the second only when low is flushed, and
+   the rest at setup, on errors, or when streaming. The first two blocks take
+   56 bytes, so they share one cache line. Against the original order, with
+   low, rng and cnt last, this saves about 3% per symbol on
+   pwdc_enc_test's skewed trace and over its tile pool.*/
 struct od_ec_enc {
-  /*Buffered output.
-    This contains only the raw bits until the final call to od_ec_enc_done(),
-     where all the arithmetic-coded data gets prepended to it.*/
-  unsigned char *buf;
-  /*The size of the buffer.*/
-  uint32_t storage;
-  /*The offset at which the next entropy-coded byte will be written.*/
-  uint32_t offs;
   /*The low end of the current range.*/
   od_ec_enc_window low;
   /*The number of values in the current range.*/
   uint16_t rng;
   /*The number of bits of data in the current value.*/
   int16_t cnt;
+  /*The offset at which the next entropy-coded byte will be written.*/
+  uint32_t offs;
+  /*When non-NULL, aom_write()/aom_write_symbol() append records here
+     instead of coding them (see entenc_pipe.h).*/
+  struct od_ec_symbuf *symbuf;
+  /*When non-NULL, aom_write_symbol() also feeds each symbol to this
+     adaptation study (see pwdc_adapt.h).*/
+  struct pwdc_adapt *adapt;
+  /*Buffered output.
+    This contains only the raw bits until the final call to od_ec_enc_done(),
+     where all the arithmetic-coded data gets prepended to it.*/
+  unsigned char *buf;
+  /*The size of the buffer.*/
+  uint32_t storage;
+  /*The flush path takes its slow branch (grow the buffer, check the byte
+     budget) once offs + sizeof(od_ec_enc_window) passes this: storage, or
+     the budget if that is smaller, or 0 after an error.*/
+  uint32_t limit;
+  /*The number of 0xFF bytes immediately before offs that a future carry would
+     still have to ripple through (bounded-carry mode only).*/
+  uint32_t ff_run;
+  /*Nonzero to track pending 0xFF runs as a counter instead of walking them
+     backwards on every carry.*/
+  int bounded_carry;
   /*Nonzero if an error occurred.*/
   int error;
+  /*The byte budget set by od_ec_enc_set_budget(), or 0 for none.*/
+  uint32_t budget;
+  /*Set once od_ec_enc_tell() passes 8 * budget.*/
+  int over_budget;
+  /*Streaming output: called with each newly committed byte range.*/
+  od_ec_enc_stream_fn stream_fn;
+  void *stream_priv;
+  /*The smallest range handed to stream_fn before od_ec_enc_done().*/
+  uint32_t stream_min;
+  /*The number of leading bytes of buf already handed out.*/
+  uint32_t emitted;
+  /*Bytes output per encode, including the ones od_ec_enc_done() adds, as
+     a peak that decays by 1/8 every od_ec_enc_recycle().*/
+  uint32_t hwm;
 #if OD_MEASURE_EC_OVERHEAD
   double entropy;
   int nb_symbols;
@@ -51,15 +113,105 @@ struct od_ec_enc {
 
 /*See entenc.c for further documentation.*/
 
+/* Per-frame PWDC statistics, accumulated per thread by every encoder running
+   on it. */
+typedef struct {
+  uint64_t total_symbols;
+  uint64_t total_bits_arith;  /* Bits used by arithmetic coder */
+  uint64_t channel_hits[128]; /* Hits per wavelength channel */
+  uint64_t bool_count[2];     /* Count of 0s and 1s in bool encoding */
+  uint64_t carry_count;       /* Carries propagated into written bytes */
+  uint64_t carry_bytes;       /* Bytes rewritten by carry propagation */
+  uint64_t carry_max_run;     /* Longest carry chain seen, in bytes */
+  uint64_t flush_count;       /* Times od_ec_enc_normalize() flushed low */
+  uint64_t bool_runs;         /* Runs of 2+ bools with the same value and f */
+  uint64_t bool_run_syms;     /* Bools inside those runs */
+  uint64_t bool_run_hist[8];  /* Runs by length: 2-3, 4-7, ..., 256+ */
+} pwdc_stats;
+
+typedef struct pwdc_ctx_stats pwdc_ctx_stats;
+
+/* Copies out or clears the calling thread's statistics, e.g. at the end of
+   each frame.
+   Only symbols coded on the calling thread are seen. Tiles that an
+   od_ec_tile_pool codes on its workers count on those threads, where nothing
+   reads them unless a pwdc_agg is attached (od_ec_tile_pool_set_stats()).
+   With one attached, each thread that codes a tile, the calling thread
+   included, moves its statistics into the pwdc_agg and resets them after the
+   tile. Without CONFIG_MULTITHREAD the calling thread codes every tile, so
+   its own statistics are cleared after each one and the frame's totals are
+   only in the pwdc_agg. */
+void pwdc_stats_get(pwdc_stats *stats) OD_ARG_NONNULL(1);
+void pwdc_stats_reset(void);
+
+/* For a thread that codes on another's behalf (see od_ec_pipe): moves the
+   calling thread's statistics into stats, ending any bool run in progress,
+   and resets them. The owner then adds them to its own with
+   pwdc_stats_add(), which combines carry_max_run with max(). */
+void pwdc_stats_take(pwdc_stats *stats) OD_ARG_NONNULL(1);
+void pwdc_stats_add(const pwdc_stats *stats) OD_ARG_NONNULL(1);
+
+/* Per-context symbol counts, gathered when deferred records with contexts
+   (see od_ec_symbuf_track_contexts()) are coded by od_ec_encode_syms().
+   Contexts 1 to num_ctx - 1 are counted, in 16-bit counters in compact mode
+   (32 bytes per context). The counts belong to the object rather than to a
+   thread, so they can be gathered on a pipe thread and read by the producer
+   once od_ec_pipe_finish() has returned. Returns NULL on failure. */
+pwdc_ctx_stats *pwdc_ctx_stats_create(uint32_t num_ctx);
+void pwdc_ctx_stats_destroy(pwdc_ctx_stats *cs);
+void pwdc_ctx_stats_reset(pwdc_ctx_stats *cs) OD_ARG_NONNULL(1);
+void pwdc_ctx_stats_get(const pwdc_ctx_stats *cs, uint32_t ctx,
+                        uint64_t counts[16]) OD_ARG_NONNULL(1);
+
+/*aom_write() probabilities (8-bit, of a zero) mapped to the Q15 probability
+   of a one that od_ec_encode_bool_q15() takes.*/
+extern const uint16_t od_ec_prob8_q15[256];
+
 void od_ec_enc_init(od_ec_enc *enc, uint32_t size) OD_ARG_NONNULL(1);
 void od_ec_enc_reset(od_ec_enc *enc) OD_ARG_NONNULL(1);
 void od_ec_enc_clear(od_ec_enc *enc) OD_ARG_NONNULL(1);
+void od_ec_enc_recycle(od_ec_enc *enc) OD_ARG_NONNULL(1);
+OD_WARN_UNUSED_RESULT size_t od_ec_enc_memory_usage(const od_ec_enc *enc)
+    OD_ARG_NONNULL(1);
+void od_ec_enc_set_bounded_carry(od_ec_enc *enc, int enable) OD_ARG_NONNULL(1);
+void od_ec_enc_set_stream(od_ec_enc *enc, od_ec_enc_stream_fn fn, void *priv,
+                          uint32_t min_bytes) OD_ARG_NONNULL(1);
+void od_ec_enc_set_budget(od_ec_enc *enc, uint32_t nbytes) OD_ARG_NONNULL(1);
+
+// Nonzero once the encoder has gone over the budget set with
+// od_ec_enc_set_budget(). Cheap enough to check after every block.
+// While records are deferred into an od_ec_symbuf the flag is stale, and
+// with a pipe it is written by the pipe thread, so it may only be read once
+// the buffer is detached; use od_ec_pipe_over_budget() in the meantime.
+static inline int od_ec_enc_over_budget(const od_ec_enc *enc) {
+  assert(enc->symbuf == NULL);
+  return enc->over_budget;
+}
 
 void od_ec_encode_bool_q15(od_ec_enc *enc, int val, unsigned f_q15)
     OD_ARG_NONNULL(1);
+void od_ec_encode_bool_half(od_ec_enc *enc, int val) OD_ARG_NONNULL(1);
+void od_ec_encode_bool_run_q15(od_ec_enc *enc, int val, unsigned f_q15,
+                               uint32_t n) OD_ARG_NONNULL(1);
 void od_ec_encode_cdf_q15(od_ec_enc *enc, int s, const uint16_t *cdf, int nsyms)
     OD_ARG_NONNULL(1) OD_ARG_NONNULL(3);
 
+/*Alphabet sizes that get a dedicated od_ec_encode_cdf_q15_<n>() kernel.
+  od_ec_encode_cdf_q15() dispatches to them; callers that know nsyms at
+  compile time can call them directly.*/
+#define OD_EC_CDF_SIZES(X) X(2) X(3) X(4) X(8) X(13) X(16)
+
+#define OD_EC_DECLARE_ENCODE_CDF_Q15(n)                                     \
+  void od_ec_encode_cdf_q15_##n(od_ec_enc *enc, int s, const uint16_t *cdf) \
+      OD_ARG_NONNULL(1) OD_ARG_NONNULL(3);
+OD_EC_CDF_SIZES(OD_EC_DECLARE_ENCODE_CDF_Q15)
+#undef OD_EC_DECLARE_ENCODE_CDF_Q15
+
+/* Codes n deferred records, counting them by context into ctx_stats unless
+   it is NULL. */
+void od_ec_encode_syms(od_ec_enc *enc, const od_ec_sym *syms, uint32_t n,
+                       pwdc_ctx_stats *ctx_stats) OD_ARG_NONNULL(1);
+
 void od_ec_enc_bits(od_ec_enc *enc, uint32_t fl, unsigned ftb)
     OD_ARG_NONNULL(1);
 
@@ -71,15 +223,46 @@ OD_WARN_UNUSED_RESULT int od_ec_enc_tell(const od_ec_enc *enc)
     OD_ARG_NONNULL(1);
 OD_WARN_UNUSED_RESULT uint32_t od_ec_enc_tell_frac(const od_ec_enc *enc)
     OD_ARG_NONNULL(1);
+OD_WARN_UNUSED_RESULT uint32_t od_ec_enc_committed(const od_ec_enc *enc)
+    OD_ARG_NONNULL(1);
+OD_WARN_UNUSED_RESULT const unsigned char *od_ec_enc_stream_pull(
+    od_ec_enc *enc, uint32_t *nbytes) OD_ARG_NONNULL(1) OD_ARG_NONNULL(2);
 
-// buf is the frame bitbuffer, offs is where carry to be added
-static inline void propagate_carry_bwd(unsigned char *buf, uint32_t offs) {
+// buf is the frame bitbuffer, offs is where carry to be added. Returns the
+// number of bytes the carry touched.
+static inline uint32_t propagate_carry_bwd(unsigned char *buf, uint32_t offs) {
   uint16_t sum, carry = 1;
+  uint32_t len = 0;
   do {
     sum = (uint16_t)buf[offs] + 1;
     buf[offs--] = (unsigned char)sum;
     carry = sum >> 8;
+    len++;
   } while (carry);
+  return len;
+}
+
+// Bounded-carry counterpart of propagate_carry_bwd(). end is the offset just
+// past the pending run and ff_run the number of 0xFF bytes in it, so the
+// carry target is found in O(1) instead of by walking back byte by byte.
+// Returns the number of bytes the carry touched.
+static inline uint32_t propagate_carry_bounded(unsigned char *buf, uint32_t end,
+                                               uint32_t ff_run) {
+  assert(end > ff_run);
+  const uint32_t pos = end - ff_run - 1;
+  assert(buf[pos] != 0xFF);
+  buf[pos]++;
+  memset(&buf[pos + 1], 0, ff_run);
+  return ff_run + 1;
+}
+
+// Number of 0xFF bytes at the end of the num_bytes big-endian bytes held in
+// the low end of output.
+static inline uint32_t count_trailing_ff(od_ec_enc_window output,
+                                         int num_bytes) {
+  int n = 0;
+  while (n < num_bytes && ((output >> (n << 3)) & 0xFF) == 0xFF) n++;
+  return n;
 }
 
 // Convert to big-endian byte order and write data to buffer adding the
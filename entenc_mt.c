@@ -0,0 +1,460 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aom_dsp/entenc_mt.h"
+#include "aom_dsp/pwdc_agg.h"
+#include "aom_mem/aom_mem.h"
+#include "aom_ports/mem.h"
+#include "aom_util/aom_thread.h"
+
+#if CONFIG_MULTITHREAD
+#include "aom_util/aom_pthread.h"
+#endif
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+/*Initial od_ec_enc buffer size for each tile, as in aom_start_encode().*/
+#define OD_EC_TILE_INIT_SIZE (62025)
+
+/*Jobs and deques are written by different workers at once, so both arrays
+   are allocated on cache line boundaries and each element starts a line.*/
+#define OD_EC_TILE_ALIGN (64)
+
+/*The writer is aligned here rather than in aom_writer itself, so only the
+   pool's jobs pay for the padding.*/
+typedef struct {
+  DECLARE_ALIGNED(OD_EC_TILE_ALIGN, aom_writer, w);
+  const unsigned char *data;
+  uint32_t nbytes;
+  int status;
+} od_ec_tile_job;
+
+/*Tile indices still to be coded by one worker. The owner takes from the
+   head, thieves take from the tail.*/
+typedef struct {
+  DECLARE_ALIGNED(OD_EC_TILE_ALIGN, int, head);
+  int tail;
+  int *tiles;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t mutex;
+#endif
+} od_ec_tile_deque;
+
+/*Worker 0 is the thread that calls od_ec_tile_pool_encode() and leaves its
+   AVxWorker unused.*/
+typedef struct {
+  AVxWorker worker;
+  od_ec_tile_pool *pool;
+  int id;
+  /*Tiles this worker took from the others in the current frame.*/
+  int steals;
+} od_ec_tile_worker;
+
+typedef struct {
+  uint32_t cost;
+  int idx;
+} od_ec_tile_order;
+
+struct od_ec_tile_pool {
+  int num_workers;
+  od_ec_tile_deque *deques;
+  od_ec_tile_worker *workers;
+  od_ec_tile_job *jobs;
+  od_ec_tile_order *order;
+  /*The tile size fields referenced by od_ec_tile_pool_segments(), 4 bytes
+     per tile.*/
+  unsigned char *size_fields;
+  int jobs_alloc;
+  /*The frame being coded.*/
+  od_ec_tile_fn fn;
+  void *priv;
+  int num_tiles;
+  int steals;
+  /*Receives each worker's statistics after every tile. May be NULL.*/
+  pwdc_agg *agg;
+  /*Workers 1 to num_threads have had their AVxWorker set up.*/
+  int num_threads;
+};
+
+static int od_ec_tile_deque_pop(od_ec_tile_deque *d, int steal, int *tile) {
+  int ok = 0;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&d->mutex);
+#endif
+  if (d->head < d->tail) {
+    *tile = steal ? d->tiles[--d->tail] : d->tiles[d->head++];
+    ok = 1;
+  }
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(&d->mutex);
+#endif
+  return ok;
+}
+
+static void od_ec_tile_run(od_ec_tile_pool *pool, int tile_idx) {
+  od_ec_tile_job *job = &pool->jobs[tile_idx];
+  od_ec_enc_recycle(&job->w.ec);
+  job->w.allow_update_cdf = 1;
+  job->data = NULL;
+  job->nbytes = 0;
+  job->status = pool->fn(pool->priv, tile_idx, &job->w);
+  if (job->status == 0) {
+    job->data = od_ec_enc_done(&job->w.ec, &job->nbytes);
+    if (job->data == NULL) job->status = -1;
+  }
+  if (pool->agg != NULL) pwdc_agg_merge_thread(pool->agg);
+}
+
+/*Drains the worker's own deque, then steals until every deque is empty.
+  Tiles are never added mid-frame, so an empty sweep means the frame is
+  done. Returns the number of tiles stolen.*/
+static int od_ec_tile_work(od_ec_tile_pool *pool, int id) {
+  const int n = pool->num_workers;
+  int steals = 0;
+  int tile = 0;
+  for (;;) {
+    if (od_ec_tile_deque_pop(&pool->deques[id], 0, &tile)) {
+      od_ec_tile_run(pool, tile);
+      continue;
+    }
+    int k;
+    for (k = 1; k < n; k++) {
+      if (od_ec_tile_deque_pop(&pool->deques[(id + k) % n], 1, &tile)) break;
+    }
+    if (k == n) break;
+    steals++;
+    od_ec_tile_run(pool, tile);
+  }
+  return steals;
+}
+
+static int od_ec_tile_worker_hook(void *arg1, void *unused) {
+  od_ec_tile_worker *worker = (od_ec_tile_worker *)arg1;
+  (void)unused;
+  worker->steals = od_ec_tile_work(worker->pool, worker->id);
+  return 1;
+}
+
+od_ec_tile_pool *od_ec_tile_pool_create(int num_workers) {
+  od_ec_tile_pool *pool = (od_ec_tile_pool *)aom_calloc(1, sizeof(*pool));
+  if (pool == NULL) return NULL;
+#if CONFIG_MULTITHREAD
+  num_workers = OD_MAXI(num_workers, 1);
+#else
+  num_workers = 1;
+#endif
+  pool->num_workers = num_workers;
+  pool->deques = (od_ec_tile_deque *)aom_memalign(
+      OD_EC_TILE_ALIGN, num_workers * sizeof(*pool->deques));
+  pool->workers =
+      (od_ec_tile_worker *)aom_calloc(num_workers, sizeof(*pool->workers));
+  if (pool->deques == NULL || pool->workers == NULL) {
+    aom_free(pool->deques);
+    aom_free(pool->workers);
+    aom_free(pool);
+    return NULL;
+  }
+  memset(pool->deques, 0, num_workers * sizeof(*pool->deques));
+  for (int i = 0; i < num_workers; i++) {
+    pool->workers[i].pool = pool;
+    pool->workers[i].id = i;
+#if CONFIG_MULTITHREAD
+    pthread_mutex_init(&pool->deques[i].mutex, NULL);
+#endif
+  }
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  for (int i = 1; i < num_workers; i++) {
+    AVxWorker *const worker = &pool->workers[i].worker;
+    winterface->init(worker);
+    worker->thread_name = "od_ec tile";
+    /*Counted first, so destroy() ends it even if it fails to start.*/
+    pool->num_threads++;
+    if (!winterface->reset(worker)) {
+      od_ec_tile_pool_destroy(pool);
+      return NULL;
+    }
+    worker->hook = od_ec_tile_worker_hook;
+    worker->data1 = &pool->workers[i];
+    worker->data2 = NULL;
+  }
+  return pool;
+}
+
+void od_ec_tile_pool_destroy(od_ec_tile_pool *pool) {
+  if (pool == NULL) return;
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  for (int i = 1; i <= pool->num_threads; i++) {
+    winterface->end(&pool->workers[i].worker);
+  }
+  for (int i = 0; i < pool->num_workers; i++) {
+#if CONFIG_MULTITHREAD
+    pthread_mutex_destroy(&pool->deques[i].mutex);
+#endif
+    aom_free(pool->deques[i].tiles);
+  }
+  for (int i = 0; i < pool->jobs_alloc; i++) {
+    od_ec_enc_clear(&pool->jobs[i].w.ec);
+  }
+  aom_free(pool->jobs);
+  aom_free(pool->order);
+  aom_free(pool->size_fields);
+  aom_free(pool->deques);
+  aom_free(pool->workers);
+  aom_free(pool);
+}
+
+static int od_ec_tile_pool_alloc(od_ec_tile_pool *pool, int num_tiles) {
+  if (num_tiles <= pool->jobs_alloc) return 0;
+  /*The scratch arrays are sized first, so jobs_alloc never claims more
+     capacity than they have. They are refilled by every encode, so nothing
+     is copied over.*/
+  aom_free(pool->order);
+  pool->order =
+      (od_ec_tile_order *)aom_malloc(sizeof(*pool->order) * num_tiles);
+  aom_free(pool->size_fields);
+  pool->size_fields = (unsigned char *)aom_malloc(4 * (size_t)num_tiles);
+  if (pool->order == NULL || pool->size_fields == NULL) return -1;
+  for (int i = 0; i < pool->num_workers; i++) {
+    od_ec_tile_deque *d = &pool->deques[i];
+    aom_free(d->tiles);
+    d->tiles = (int *)aom_malloc(sizeof(*d->tiles) * num_tiles);
+    if (d->tiles == NULL) return -1;
+  }
+  /*The jobs are grown by copying, keeping their alignment. The encoders
+     hold no pointers into themselves and survive the move.*/
+  od_ec_tile_job *jobs = (od_ec_tile_job *)aom_memalign(
+      OD_EC_TILE_ALIGN, sizeof(*jobs) * num_tiles);
+  if (jobs == NULL) return -1;
+  if (pool->jobs_alloc > 0) {
+    memcpy(jobs, pool->jobs, sizeof(*jobs) * pool->jobs_alloc);
+  }
+  aom_free(pool->jobs);
+  pool->jobs = jobs;
+  for (; pool->jobs_alloc < num_tiles; pool->jobs_alloc++) {
+    od_ec_tile_job *job = &jobs[pool->jobs_alloc];
+    memset(job, 0, sizeof(*job));
+    od_ec_enc_init(&job->w.ec, OD_EC_TILE_INIT_SIZE);
+    if (job->w.ec.error) {
+      od_ec_enc_clear(&job->w.ec);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+static int od_ec_tile_order_cmp(const void *a, const void *b) {
+  const od_ec_tile_order *x = (const od_ec_tile_order *)a;
+  const od_ec_tile_order *y = (const od_ec_tile_order *)b;
+  if (x->cost != y->cost) return x->cost > y->cost ? -1 : 1;
+  return x->idx - y->idx;
+}
+
+int od_ec_tile_pool_encode(od_ec_tile_pool *pool, int num_tiles,
+                           const uint32_t *est_cost, od_ec_tile_fn fn,
+                           void *priv) {
+  const int n = pool->num_workers;
+  if (num_tiles <= 0) return 0;
+  if (od_ec_tile_pool_alloc(pool, num_tiles)) return -1;
+  pool->fn = fn;
+  pool->priv = priv;
+  pool->num_tiles = num_tiles;
+  pool->steals = 0;
+
+  /*Deal the tiles round-robin, largest first, so each worker starts on its
+     biggest tile and the small ones are left for balancing at the end.*/
+  for (int i = 0; i < num_tiles; i++) {
+    pool->order[i].cost = est_cost != NULL ? est_cost[i] : 0;
+    pool->order[i].idx = i;
+  }
+  if (est_cost != NULL) {
+    qsort(pool->order, num_tiles, sizeof(*pool->order), od_ec_tile_order_cmp);
+  }
+  for (int i = 0; i < n; i++) {
+    pool->deques[i].head = 0;
+    pool->deques[i].tail = 0;
+  }
+  for (int i = 0; i < num_tiles; i++) {
+    od_ec_tile_deque *d = &pool->deques[i % n];
+    d->tiles[d->tail++] = pool->order[i].idx;
+  }
+
+  /*Stealing happens inside od_ec_tile_work(), so every worker is launched
+     once and the frame is done when all of them have returned.*/
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  for (int i = 1; i < n; i++) winterface->launch(&pool->workers[i].worker);
+  pool->steals = od_ec_tile_work(pool, 0);
+  for (int i = 1; i < n; i++) {
+    winterface->sync(&pool->workers[i].worker);
+    pool->steals += pool->workers[i].steals;
+  }
+
+  for (int i = 0; i < num_tiles; i++) {
+    if (pool->jobs[i].status) return -1;
+  }
+  return 0;
+}
+
+const unsigned char *od_ec_tile_pool_get_tile(const od_ec_tile_pool *pool,
+                                              int tile_idx, uint32_t *nbytes) {
+  assert(tile_idx >= 0 && tile_idx < pool->num_tiles);
+  *nbytes = pool->jobs[tile_idx].nbytes;
+  return pool->jobs[tile_idx].data;
+}
+
+/*Returns 0 if a tile of nbytes can be preceded by a size field of
+   tile_size_bytes.*/
+static int od_ec_tile_check_size(uint32_t nbytes, int tile_size_bytes) {
+  if (nbytes == 0) return -1;
+  if (tile_size_bytes < 4 && (nbytes - 1) >> (tile_size_bytes << 3) != 0) {
+    return -1;
+  }
+  return 0;
+}
+
+int64_t od_ec_tile_pool_stitch(const od_ec_tile_pool *pool, unsigned char *dst,
+                               size_t dst_size, int tile_size_bytes,
+                               uint32_t *tile_offsets) {
+  const int num_tiles = pool->num_tiles;
+  size_t total = 0;
+  assert(tile_size_bytes >= 0 && tile_size_bytes <= 4);
+  /*Precompute every offset first so an undersized dst is rejected before
+     anything is written.*/
+  for (int i = 0; i < num_tiles; i++) {
+    const uint32_t nbytes = pool->jobs[i].nbytes;
+    if (i < num_tiles - 1 && tile_size_bytes > 0) {
+      if (od_ec_tile_check_size(nbytes, tile_size_bytes)) return -1;
+      total += tile_size_bytes;
+    }
+    if (tile_offsets != NULL) tile_offsets[i] = (uint32_t)total;
+    total += nbytes;
+  }
+  if (total > dst_size) return -1;
+  size_t offs = 0;
+  for (int i = 0; i < num_tiles; i++) {
+    const od_ec_tile_job *job = &pool->jobs[i];
+    if (i < num_tiles - 1 && tile_size_bytes > 0) {
+      for (int b = 0; b < tile_size_bytes; b++) {
+        dst[offs++] = (unsigned char)((job->nbytes - 1) >> (b << 3));
+      }
+    }
+    memcpy(dst + offs, job->data, job->nbytes);
+    offs += job->nbytes;
+  }
+  return (int64_t)total;
+}
+
+int od_ec_tile_pool_segments(od_ec_tile_pool *pool, od_ec_tile_seg *segs,
+                             int max_segs, int tile_size_bytes) {
+  const int num_tiles = pool->num_tiles;
+  int nsegs = 0;
+  assert(tile_size_bytes >= 0 && tile_size_bytes <= 4);
+  for (int i = 0; i < num_tiles; i++) {
+    const od_ec_tile_job *job = &pool->jobs[i];
+    if (i < num_tiles - 1 && tile_size_bytes > 0) {
+      if (od_ec_tile_check_size(job->nbytes, tile_size_bytes)) return -1;
+      if (nsegs == max_segs) return -1;
+      unsigned char *field = &pool->size_fields[4 * i];
+      for (int b = 0; b < tile_size_bytes; b++) {
+        field[b] = (unsigned char)((job->nbytes - 1) >> (b << 3));
+      }
+      segs[nsegs].data = field;
+      segs[nsegs].nbytes = tile_size_bytes;
+      nsegs++;
+    }
+    if (job->nbytes == 0) continue;
+    if (nsegs == max_segs) return -1;
+    segs[nsegs].data = job->data;
+    segs[nsegs].nbytes = job->nbytes;
+    nsegs++;
+  }
+  return nsegs;
+}
+
+/*Batches of this many segments go to each writev() call; POSIX guarantees
+   IOV_MAX >= 16, Linux and the BSDs allow 1024.*/
+#define OD_EC_TILE_IOV_BATCH (64)
+
+int od_ec_tile_segs_write(int fd, const od_ec_tile_seg *segs, int nsegs) {
+  int i = 0;
+  size_t done = 0;
+  /*done counts the bytes of segs[i] already written by a partial write.*/
+  while (i < nsegs) {
+    /*Empty segments would make a write of nothing look like no progress.*/
+    if (segs[i].nbytes == done) {
+      done = 0;
+      i++;
+      continue;
+    }
+#if defined(_WIN32)
+    const int n = _write(fd, segs[i].data + done,
+                         (unsigned)OD_MINI(segs[i].nbytes - done, INT_MAX));
+    if (n < 0) return -1;
+#else
+    struct iovec iov[OD_EC_TILE_IOV_BATCH];
+    int niov = 0;
+    for (int k = i; k < nsegs && niov < OD_EC_TILE_IOV_BATCH; k++) {
+      const size_t skip = k == i ? done : 0;
+      /*writev() only reads the buffers; going through uintptr_t drops the
+         const without a -Wcast-qual warning.*/
+      iov[niov].iov_base = (void *)(uintptr_t)(segs[k].data + skip);
+      iov[niov].iov_len = segs[k].nbytes - skip;
+      niov++;
+    }
+    const ssize_t n = writev(fd, iov, niov);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return -1;
+    }
+#endif
+    /*Nothing written with bytes left would loop forever.*/
+    if (n == 0) {
+      errno = EIO;
+      return -1;
+    }
+    size_t written = (size_t)n;
+    while (i < nsegs && written >= segs[i].nbytes - done) {
+      written -= segs[i].nbytes - done;
+      done = 0;
+      i++;
+    }
+    done += written;
+  }
+  return 0;
+}
+
+int od_ec_tile_pool_steals(const od_ec_tile_pool *pool) {
+  return pool->steals;
+}
+
+void od_ec_tile_pool_set_stats(od_ec_tile_pool *pool, pwdc_agg *agg) {
+  pool->agg = agg;
+}
+
+size_t od_ec_tile_pool_memory_usage(const od_ec_tile_pool *pool) {
+  size_t total = sizeof(*pool) + pool->num_workers * (sizeof(*pool->deques) +
+                                                      sizeof(*pool->workers));
+  total += pool->jobs_alloc * (sizeof(*pool->jobs) + sizeof(*pool->order) +
+                               pool->num_workers * sizeof(int));
+  for (int i = 0; i < pool->jobs_alloc; i++) {
+    total += od_ec_enc_memory_usage(&pool->jobs[i].w.ec);
+  }
+  return total;
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef AOM_AOM_DSP_ENTENC_MT_H_
+#define AOM_AOM_DSP_ENTENC_MT_H_
+
+#include <stddef.h>
+
+#include "config/aom_config.h"
+
+#include "aom_dsp/bitwriter.h"
+#include "aom_dsp/pwdc_agg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*Multi-tile entropy coding driver.
+  Each tile is coded into its own aom_writer by a pool of worker threads.
+  Tiles are dealt to per-worker deques (largest estimated cost first) and
+  idle workers steal from the others, so uneven tile sizes do not leave
+  threads waiting at the end of the frame. The finished od_ec_enc_done()
+  buffers are then stitched into the frame buffer at precomputed offsets.*/
+
+typedef struct od_ec_tile_pool od_ec_tile_pool;
+
+/*Codes all symbols of tile tile_idx into w.
+  w->ec has already been reset; the driver calls od_ec_enc_done() afterwards.
+  Returns 0 on success.*/
+typedef int (*od_ec_tile_fn)(void *priv, int tile_idx, aom_writer *w);
+
+/*Creates a pool that codes tiles on num_workers threads, counting the thread
+   that calls od_ec_tile_pool_encode(). Returns NULL on allocation failure.*/
+od_ec_tile_pool *od_ec_tile_pool_create(int num_workers);
+void od_ec_tile_pool_destroy(od_ec_tile_pool *pool);
+
+/*Codes num_tiles tiles with fn.
+  est_cost: Optional per-tile cost estimates (e.g. the previous frame's tile
+   sizes) used to start the largest tiles first. May be NULL.
+  Returns 0 if every tile was coded successfully.*/
+int od_ec_tile_pool_encode(od_ec_tile_pool *pool, int num_tiles,
+                           const uint32_t *est_cost, od_ec_tile_fn fn,
+                           void *priv);
+
+/*A piece of a frame's output, like a struct iovec.*/
+typedef struct {
+  const unsigned char *data;
+  size_t nbytes;
+} od_ec_tile_seg;
+
+/*Returns the coded bytes of a tile from the last od_ec_tile_pool_encode().
+  The buffer is owned by the pool and valid until the next encode call.*/
+const unsigned char *od_ec_tile_pool_get_tile(const od_ec_tile_pool *pool,
+                                              int tile_idx, uint32_t *nbytes);
+
+/*Copies the coded tiles into dst in tile order.
+  Every tile but the last is preceded by its size minus 1, little-endian in
+   tile_size_bytes bytes (0 to omit the size fields), as in AV1 tile groups.
+  tile_offsets: Optional; receives the offset of each tile's payload in dst.
+  Returns the number of bytes written, or -1 if dst is too small or a size
+   does not fit in tile_size_bytes.*/
+int64_t od_ec_tile_pool_stitch(const od_ec_tile_pool *pool, unsigned char *dst,
+                               size_t dst_size, int tile_size_bytes,
+                               uint32_t *tile_offsets);
+
+/*Describes the output of od_ec_tile_pool_stitch() as segments instead of
+   copying it: each tile's size field (kept in the pool) and each tile's
+   od_ec_enc_done() buffer, in order. The caller can put its own segments,
+   such as the OBU header, around them and hand the list to
+   od_ec_tile_segs_write(), so tile payloads are never copied in user space.
+  The segments are valid until the next od_ec_tile_pool_encode() call.
+  Returns the number of segments (at most 2 * num_tiles), or -1 if
+   max_segs is too small or a size does not fit in tile_size_bytes.*/
+int od_ec_tile_pool_segments(od_ec_tile_pool *pool, od_ec_tile_seg *segs,
+                             int max_segs, int tile_size_bytes);
+
+/*Writes the segments to a file descriptor with writev(), resuming after
+   partial writes and EINTR. Returns 0 on success, -1 on error (see errno;
+   EIO if a write made no progress).*/
+int od_ec_tile_segs_write(int fd, const od_ec_tile_seg *segs, int nsegs);
+
+/*The number of tiles taken from another worker's deque in the last
+   od_ec_tile_pool_encode() call.*/
+int od_ec_tile_pool_steals(const od_ec_tile_pool *pool);
+
+/*Has every worker move its thread's PWDC statistics into agg (see
+   pwdc_agg_merge_thread()) after each tile, so agg can be read while the
+   frame is still being coded. NULL turns this off.*/
+void od_ec_tile_pool_set_stats(od_ec_tile_pool *pool, pwdc_agg *agg);
+
+/*Heap bytes held by the pool, including every tile's output buffer. Tile
+   encoders are kept across frames and resized with od_ec_enc_recycle(), so
+   this follows recent tile sizes rather than the largest ever seen.*/
+size_t od_ec_tile_pool_memory_usage(const od_ec_tile_pool *pool);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_AOM_DSP_ENTENC_MT_H_
@@ -0,0 +1,332 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aom_dsp/entenc_pipe.h"
+
+#if CONFIG_MULTITHREAD
+#include <stdatomic.h>
+
+#include "aom_util/aom_pthread.h"
+#endif
+
+struct od_ec_pipe {
+  od_ec_symbuf *sb;
+  od_ec_enc *enc;
+#if CONFIG_MULTITHREAD
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t work_cond;
+  pthread_cond_t done_cond;
+  /*Full blocks handed over by the producer, and how many were coded.*/
+  uint32_t sealed;
+  uint32_t consumed;
+  /*The next block to code.*/
+  od_ec_symbuf_block *rd;
+  /*Set by od_ec_pipe_finish() with the record count of the last block.*/
+  int finished;
+  uint32_t tail;
+  int active;
+  int quit;
+  /*The statistics of the records coded on the pipe thread, which keeps
+     them in its own thread-local pwdc_stats; handed back by finish.*/
+  pwdc_stats stats;
+  /*enc->over_budget as of the last coded block, published for the
+     producer, which must not read enc while the pipe thread codes into it.*/
+  atomic_int over_budget;
+#else
+  int over_budget;
+#endif
+};
+
+/* ========== Symbol arena ========== */
+
+void od_ec_symbuf_init(od_ec_symbuf *sb) { memset(sb, 0, sizeof(*sb)); }
+
+void od_ec_symbuf_reset(od_ec_symbuf *sb) {
+  if (sb->ctx_keys != NULL) {
+    memset(sb->ctx_keys, 0, sizeof(*sb->ctx_keys) * (sb->ctx_mask + 1));
+    sb->num_ctx = 0;
+  }
+  sb->cur = sb->head;
+  sb->pos = sb->head != NULL ? sb->head->syms : NULL;
+  sb->end = sb->head != NULL ? sb->head->syms + OD_EC_SYMBUF_BLOCK_SIZE : NULL;
+  sb->nblocks = 0;
+  sb->error = 0;
+}
+
+void od_ec_symbuf_clear(od_ec_symbuf *sb) {
+  od_ec_symbuf_block *blk = sb->head;
+  while (blk != NULL) {
+    od_ec_symbuf_block *next = blk->next;
+    free(blk);
+    blk = next;
+  }
+  free(sb->ctx_keys);
+  free(sb->ctx_ids);
+  od_ec_symbuf_init(sb);
+}
+
+/*Initial size of the context hash table; it doubles at 50% load.*/
+#define OD_EC_SYMBUF_CTX_INIT (1024)
+
+static int od_ec_symbuf_alloc_contexts(od_ec_symbuf *sb, uint32_t size) {
+  const void **keys = (const void **)calloc(size, sizeof(*keys));
+  uint16_t *ids = (uint16_t *)malloc(sizeof(*ids) * size);
+  if (keys == NULL || ids == NULL) {
+    free(keys);
+    free(ids);
+    return -1;
+  }
+  /*Rehash the existing entries.*/
+  for (uint32_t i = 0; sb->ctx_keys != NULL && i <= sb->ctx_mask; i++) {
+    if (sb->ctx_keys[i] == NULL) continue;
+    uint32_t h = ((uint32_t)((uintptr_t)sb->ctx_keys[i] >> 1) * 0x9E3779B1U) &
+                 (size - 1);
+    while (keys[h] != NULL) h = (h + 1) & (size - 1);
+    keys[h] = sb->ctx_keys[i];
+    ids[h] = sb->ctx_ids[i];
+  }
+  free(sb->ctx_keys);
+  free(sb->ctx_ids);
+  sb->ctx_keys = keys;
+  sb->ctx_ids = ids;
+  sb->ctx_mask = size - 1;
+  return 0;
+}
+
+int od_ec_symbuf_track_contexts(od_ec_symbuf *sb) {
+  if (sb->ctx_keys != NULL) return 0;
+  sb->num_ctx = 0;
+  return od_ec_symbuf_alloc_contexts(sb, OD_EC_SYMBUF_CTX_INIT);
+}
+
+uint16_t od_ec_symbuf_context(od_ec_symbuf *sb, const void *cdf) {
+  uint32_t h =
+      ((uint32_t)((uintptr_t)cdf >> 1) * 0x9E3779B1U) & sb->ctx_mask;
+  while (sb->ctx_keys[h] != NULL) {
+    if (sb->ctx_keys[h] == cdf) return sb->ctx_ids[h];
+    h = (h + 1) & sb->ctx_mask;
+  }
+  if (sb->num_ctx == UINT16_MAX) return 0;
+  if (2 * (sb->num_ctx + 1) > sb->ctx_mask + 1) {
+    if (od_ec_symbuf_alloc_contexts(sb, 2 * (sb->ctx_mask + 1))) return 0;
+    return od_ec_symbuf_context(sb, cdf);
+  }
+  sb->ctx_keys[h] = cdf;
+  sb->ctx_ids[h] = (uint16_t)++sb->num_ctx;
+  return sb->ctx_ids[h];
+}
+
+static od_ec_symbuf_block *od_ec_symbuf_alloc_block(void) {
+  od_ec_symbuf_block *blk =
+      (od_ec_symbuf_block *)malloc(sizeof(od_ec_symbuf_block));
+  if (blk != NULL) blk->next = NULL;
+  return blk;
+}
+
+int od_ec_symbuf_next_block(od_ec_symbuf *sb) {
+  if (sb->error) return -1;
+  if (sb->cur == NULL) {
+    assert(sb->head == NULL);
+    sb->head = od_ec_symbuf_alloc_block();
+    if (sb->head == NULL) {
+      sb->error = 1;
+      return -1;
+    }
+    sb->cur = sb->head;
+  } else {
+    if (sb->cur->next == NULL) {
+      sb->cur->next = od_ec_symbuf_alloc_block();
+      if (sb->cur->next == NULL) {
+        sb->error = 1;
+        return -1;
+      }
+    }
+    /*Link before publishing, so the consumer can always follow next.*/
+    sb->cur = sb->cur->next;
+    sb->nblocks++;
+    if (sb->pipe != NULL) od_ec_pipe_publish(sb->pipe, sb->nblocks);
+  }
+  sb->pos = sb->cur->syms;
+  sb->end = sb->cur->syms + OD_EC_SYMBUF_BLOCK_SIZE;
+  return 0;
+}
+
+uint32_t od_ec_symbuf_count(const od_ec_symbuf *sb) {
+  const uint32_t tail =
+      sb->cur != NULL ? (uint32_t)(sb->pos - sb->cur->syms) : 0;
+  return sb->nblocks * OD_EC_SYMBUF_BLOCK_SIZE + tail;
+}
+
+void od_ec_symbuf_drain(const od_ec_symbuf *sb, od_ec_enc *enc) {
+  const od_ec_symbuf_block *blk = sb->head;
+  for (uint32_t i = 0; i < sb->nblocks; i++) {
+    od_ec_encode_syms(enc, blk->syms, OD_EC_SYMBUF_BLOCK_SIZE,
+                      sb->ctx_stats);
+    blk = blk->next;
+  }
+  if (sb->cur != NULL) {
+    od_ec_encode_syms(enc, sb->cur->syms, (uint32_t)(sb->pos - sb->cur->syms),
+                      sb->ctx_stats);
+  }
+}
+
+void od_ec_cost_init(uint16_t cost[OD_EC_COST_PROB_TOP + 1]) {
+  for (int k = 1; k <= OD_EC_COST_PROB_TOP; k++) {
+    cost[k] = (uint16_t)lrint(-256 * log2((double)k / OD_EC_COST_PROB_TOP));
+  }
+  cost[0] = cost[1];
+}
+
+/* ========== Pipeline stage ========== */
+
+#if CONFIG_MULTITHREAD
+static void *od_ec_pipe_hook(void *arg) {
+  od_ec_pipe *pipe = (od_ec_pipe *)arg;
+  pthread_mutex_lock(&pipe->mutex);
+  for (;;) {
+    while (!pipe->quit &&
+           !(pipe->active &&
+             (pipe->consumed < pipe->sealed || pipe->finished))) {
+      pthread_cond_wait(&pipe->work_cond, &pipe->mutex);
+    }
+    if (pipe->quit) break;
+    if (pipe->rd == NULL) pipe->rd = pipe->sb->head;
+    od_ec_symbuf_block *blk = pipe->rd;
+    if (pipe->consumed < pipe->sealed) {
+      pthread_mutex_unlock(&pipe->mutex);
+      od_ec_encode_syms(pipe->enc, blk->syms, OD_EC_SYMBUF_BLOCK_SIZE,
+                        pipe->sb->ctx_stats);
+      if (pipe->enc->over_budget) {
+        atomic_store_explicit(&pipe->over_budget, 1, memory_order_relaxed);
+      }
+      pthread_mutex_lock(&pipe->mutex);
+      pipe->rd = blk->next;
+      pipe->consumed++;
+      continue;
+    }
+    const uint32_t tail = pipe->tail;
+    pthread_mutex_unlock(&pipe->mutex);
+    if (tail > 0) {
+      od_ec_encode_syms(pipe->enc, blk->syms, tail, pipe->sb->ctx_stats);
+    }
+    pwdc_stats_take(&pipe->stats);
+    pthread_mutex_lock(&pipe->mutex);
+    pipe->active = 0;
+    pthread_cond_signal(&pipe->done_cond);
+  }
+  pthread_mutex_unlock(&pipe->mutex);
+  return NULL;
+}
+#endif  // CONFIG_MULTITHREAD
+
+od_ec_pipe *od_ec_pipe_create(void) {
+  od_ec_pipe *pipe = (od_ec_pipe *)calloc(1, sizeof(*pipe));
+  if (pipe == NULL) return NULL;
+#if CONFIG_MULTITHREAD
+  atomic_init(&pipe->over_budget, 0);
+  pthread_mutex_init(&pipe->mutex, NULL);
+  pthread_cond_init(&pipe->work_cond, NULL);
+  pthread_cond_init(&pipe->done_cond, NULL);
+  if (pthread_create(&pipe->thread, NULL, od_ec_pipe_hook, pipe)) {
+    pthread_cond_destroy(&pipe->done_cond);
+    pthread_cond_destroy(&pipe->work_cond);
+    pthread_mutex_destroy(&pipe->mutex);
+    free(pipe);
+    return NULL;
+  }
+#endif
+  return pipe;
+}
+
+void od_ec_pipe_destroy(od_ec_pipe *pipe) {
+  if (pipe == NULL) return;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&pipe->mutex);
+  pipe->quit = 1;
+  pthread_cond_signal(&pipe->work_cond);
+  pthread_mutex_unlock(&pipe->mutex);
+  pthread_join(pipe->thread, NULL);
+  pthread_cond_destroy(&pipe->done_cond);
+  pthread_cond_destroy(&pipe->work_cond);
+  pthread_mutex_destroy(&pipe->mutex);
+#endif
+  free(pipe);
+}
+
+void od_ec_pipe_begin(od_ec_pipe *pipe, od_ec_symbuf *sb, od_ec_enc *enc) {
+  od_ec_symbuf_reset(sb);
+  sb->pipe = pipe;
+  enc->symbuf = sb;
+  pipe->sb = sb;
+  pipe->enc = enc;
+#if CONFIG_MULTITHREAD
+  atomic_store_explicit(&pipe->over_budget, enc->over_budget,
+                        memory_order_relaxed);
+  pthread_mutex_lock(&pipe->mutex);
+  assert(!pipe->active);
+  pipe->sealed = 0;
+  pipe->consumed = 0;
+  pipe->rd = NULL;
+  pipe->finished = 0;
+  pipe->tail = 0;
+  pipe->active = 1;
+  pthread_mutex_unlock(&pipe->mutex);
+#else
+  pipe->over_budget = enc->over_budget;
+#endif
+}
+
+int od_ec_pipe_over_budget(const od_ec_pipe *pipe) {
+#if CONFIG_MULTITHREAD
+  return atomic_load_explicit(&pipe->over_budget, memory_order_relaxed);
+#else
+  return pipe->over_budget;
+#endif
+}
+
+void od_ec_pipe_publish(od_ec_pipe *pipe, uint32_t nblocks) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&pipe->mutex);
+  pipe->sealed = nblocks;
+  pthread_cond_signal(&pipe->work_cond);
+  pthread_mutex_unlock(&pipe->mutex);
+#else
+  (void)pipe;
+  (void)nblocks;
+#endif
+}
+
+int od_ec_pipe_finish(od_ec_pipe *pipe) {
+  od_ec_symbuf *sb = pipe->sb;
+  assert(sb != NULL);
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&pipe->mutex);
+  pipe->tail = sb->cur != NULL ? (uint32_t)(sb->pos - sb->cur->syms) : 0;
+  pipe->finished = 1;
+  pthread_cond_signal(&pipe->work_cond);
+  while (pipe->active) pthread_cond_wait(&pipe->done_cond, &pipe->mutex);
+  pthread_mutex_unlock(&pipe->mutex);
+  pwdc_stats_add(&pipe->stats);
+#else
+  od_ec_symbuf_drain(sb, pipe->enc);
+#endif
+  pipe->enc->symbuf = NULL;
+  sb->pipe = NULL;
+  pipe->sb = NULL;
+  pipe->enc = NULL;
+  return sb->error ? -1 : 0;
+}
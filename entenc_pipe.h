@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef AOM_AOM_DSP_ENTENC_PIPE_H_
+#define AOM_AOM_DSP_ENTENC_PIPE_H_
+
+#include "config/aom_config.h"
+
+#include "aom_dsp/entenc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*Deferred symbol coding.
+  While an od_ec_enc has a symbol buffer attached, aom_write() and
+   aom_write_symbol() only append an od_ec_sym record (the probabilities are
+   captured at that point, so later CDF adaptation does not matter).
+  An od_ec_pipe drains the buffer into the od_ec_enc on its own thread, taking
+   the range coder off the critical path of the thread doing mode decision.
+  The buffer is an arena of fixed-size blocks that are kept and reused from
+   one tile or frame to the next.*/
+
+/*The number of records per arena block. A block is handed to the pipe once
+   it is full, so this is also the granularity of the pipeline.*/
+#define OD_EC_SYMBUF_BLOCK_SIZE (4096)
+
+typedef struct od_ec_symbuf_block od_ec_symbuf_block;
+
+struct od_ec_symbuf_block {
+  od_ec_symbuf_block *next;
+  od_ec_sym syms[OD_EC_SYMBUF_BLOCK_SIZE];
+};
+
+typedef struct od_ec_pipe od_ec_pipe;
+
+typedef struct od_ec_symbuf {
+  /*The first block of the arena.*/
+  od_ec_symbuf_block *head;
+  /*The block being filled, and the write cursor within it.*/
+  od_ec_symbuf_block *cur;
+  od_ec_sym *pos;
+  od_ec_sym *end;
+  /*The number of full blocks before cur.*/
+  uint32_t nblocks;
+  /*The pipe draining this buffer, or NULL.*/
+  od_ec_pipe *pipe;
+  /*Optional CDF-pointer to context number map (see
+     od_ec_symbuf_track_contexts()), an open-addressed hash table.*/
+  const void **ctx_keys;
+  uint16_t *ctx_ids;
+  uint32_t ctx_mask;
+  uint32_t num_ctx;
+  /*Where the records are counted by context when they are coded, or NULL.
+     Set by the caller and kept across resets; not owned.*/
+  pwdc_ctx_stats *ctx_stats;
+  /*Nonzero if a block allocation failed; records are dropped from then on.*/
+  int error;
+} od_ec_symbuf;
+
+void od_ec_symbuf_init(od_ec_symbuf *sb) OD_ARG_NONNULL(1);
+/*Rewinds to the start of the arena, keeping every block for reuse.*/
+void od_ec_symbuf_reset(od_ec_symbuf *sb) OD_ARG_NONNULL(1);
+void od_ec_symbuf_clear(od_ec_symbuf *sb) OD_ARG_NONNULL(1);
+
+/*Moves the cursor to the next block, allocating it if needed.
+  Returns 0 on success.*/
+int od_ec_symbuf_next_block(od_ec_symbuf *sb) OD_ARG_NONNULL(1);
+
+/*The number of records appended since the last reset.*/
+OD_WARN_UNUSED_RESULT uint32_t od_ec_symbuf_count(const od_ec_symbuf *sb)
+    OD_ARG_NONNULL(1);
+
+/*Starts numbering the CDFs passed to aom_write_symbol() in od_ec_sym.ctx.
+  Numbers restart from 1 on every reset, so they follow the order of first
+   use within a tile. Returns 0 on success.*/
+int od_ec_symbuf_track_contexts(od_ec_symbuf *sb) OD_ARG_NONNULL(1);
+
+/*Returns the context number of cdf, assigning the next one on first use,
+   or 0 if there are no numbers left.*/
+uint16_t od_ec_symbuf_context(od_ec_symbuf *sb, const void *cdf)
+    OD_ARG_NONNULL(1);
+
+/*Codes every buffered record into enc on the calling thread, counting them
+   into sb->ctx_stats if it is set.*/
+void od_ec_symbuf_drain(const od_ec_symbuf *sb, od_ec_enc *enc)
+    OD_ARG_NONNULL(1) OD_ARG_NONNULL(2);
+
+static inline void od_ec_symbuf_push(od_ec_symbuf *sb, unsigned fl,
+                                     unsigned fh, int s, int nsyms,
+                                     unsigned ctx) {
+  if (sb->pos == sb->end && od_ec_symbuf_next_block(sb)) return;
+  od_ec_sym *sym = sb->pos++;
+  sym->fl = (uint16_t)fl;
+  sym->fh = (uint16_t)fh;
+  sym->ctx = (uint16_t)ctx;
+  sym->s = (uint8_t)s;
+  sym->nsyms = (uint8_t)nsyms;
+}
+
+/*The range coder only uses the top 9 bits of each Q15 probability (see
+   EC_PROB_SHIFT).*/
+#define OD_EC_COST_PROB_TOP (CDF_PROB_TOP >> EC_PROB_SHIFT)
+
+/*Fills cost with the code length in 1/256 bit of a symbol of probability
+   k/OD_EC_COST_PROB_TOP, for every k. A probability that rounds to 0 costs
+   as much as 1/OD_EC_COST_PROB_TOP.*/
+void od_ec_cost_init(uint16_t cost[OD_EC_COST_PROB_TOP + 1]) OD_ARG_NONNULL(1);
+
+/*The cost of sym with the probabilities it was captured with, in 1/256 bit.
+  This is the one estimate of the range coder output that both the 1% gate
+   of pwdc_select.h and the pwdc_static report use.*/
+static inline uint32_t od_ec_sym_cost_q8(const uint16_t *cost,
+                                         const od_ec_sym *sym) {
+  unsigned p;
+  if (sym->nsyms == 0) {
+    /*fl holds the probability of a one.*/
+    p = sym->s ? sym->fl : CDF_PROB_TOP - sym->fl;
+  } else {
+    p = sym->fl - sym->fh;
+  }
+  return cost[p >> EC_PROB_SHIFT];
+}
+
+/*Turns a sum of od_ec_sym_cost_q8() into whole bits of output, including
+   the bytes od_ec_enc_done() flushes.*/
+static inline int64_t od_ec_cost_bits(int64_t cost_q8) {
+  return ((cost_q8 + 255) >> 8) + 16;
+}
+
+/*Creates the pipeline stage and its thread. Without CONFIG_MULTITHREAD the
+   records are coded by od_ec_pipe_finish() on the calling thread.*/
+od_ec_pipe *od_ec_pipe_create(void);
+void od_ec_pipe_destroy(od_ec_pipe *pipe);
+
+/*Resets sb and attaches it to enc, so the writer wrapping enc starts
+   buffering, and lets the pipe code the records into enc as blocks fill.*/
+void od_ec_pipe_begin(od_ec_pipe *pipe, od_ec_symbuf *sb, od_ec_enc *enc)
+    OD_ARG_NONNULL(1) OD_ARG_NONNULL(2) OD_ARG_NONNULL(3);
+
+/*Waits until every record has been coded and detaches the buffer. enc is
+   then ready for od_ec_enc_done(). The statistics of the coded records are
+   added to the calling thread's (see pwdc_stats_get()), as if it had coded
+   them itself. Returns 0 on success, -1 if records were lost to an
+   allocation failure.*/
+int od_ec_pipe_finish(od_ec_pipe *pipe) OD_ARG_NONNULL(1);
+
+/*od_ec_enc_over_budget() for the encoder being coded into, which the
+   producer may call between od_ec_pipe_begin() and od_ec_pipe_finish(). It
+   is updated after every coded block, so it trails the records written so
+   far by up to the blocks the pipe has not coded yet. Without
+   CONFIG_MULTITHREAD nothing is coded before od_ec_pipe_finish(), so it only
+   reports a budget already passed at od_ec_pipe_begin().*/
+int od_ec_pipe_over_budget(const od_ec_pipe *pipe) OD_ARG_NONNULL(1);
+
+/*Called by od_ec_symbuf_next_block() when a block fills up.*/
+void od_ec_pipe_publish(od_ec_pipe *pipe, uint32_t nblocks)
+    OD_ARG_NONNULL(1);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_AOM_DSP_ENTENC_PIPE_H_
@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aom_dsp/pwdc_adapt.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PWDC_ADAPT_ROW_SSE2 (1)
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define PWDC_ADAPT_ROW_NEON (1)
+#endif
+
+/*Initial size of the context hash table; it doubles at 50% load.*/
+#define PWDC_ADAPT_CTX_INIT (1024)
+
+/*update_cdf() stops counting here.*/
+#define PWDC_ADAPT_AV1_MAX_COUNT (32)
+
+static int pwdc_adapt_model_rows(const pwdc_adapt_model *m) {
+  return m->kind == PWDC_ADAPT_TWO_SPEED ? 2 : 1;
+}
+
+int pwdc_adapt_init(pwdc_adapt *ad, const pwdc_adapt_model *models,
+                    int num_models) {
+  memset(ad, 0, sizeof(*ad));
+  if (num_models < 1 || num_models > PWDC_ADAPT_MAX_MODELS) return -1;
+  for (int m = 0; m < num_models; m++) {
+    ad->models[m] = models[m];
+    ad->row[m] = ad->num_rows;
+    ad->num_rows += pwdc_adapt_model_rows(&models[m]);
+  }
+  ad->num_models = num_models;
+  for (int i = 0; i < 256; i++) {
+    ad->log2_q16[i] = (uint32_t)lrint(65536 * log2(1 + i / 256.0));
+  }
+  return 0;
+}
+
+void pwdc_adapt_clear(pwdc_adapt *ad) {
+  free(ad->ctx_keys);
+  free(ad->ctx_ids);
+  free(ad->rows);
+  free(ad->counts);
+  ad->ctx_keys = NULL;
+  ad->ctx_ids = NULL;
+  ad->rows = NULL;
+  ad->counts = NULL;
+  ad->ctx_mask = 0;
+  ad->ctx_alloc = 0;
+  pwdc_adapt_reset(ad);
+}
+
+void pwdc_adapt_reset(pwdc_adapt *ad) {
+  if (ad->ctx_keys != NULL) {
+    memset(ad->ctx_keys, 0, sizeof(*ad->ctx_keys) * (ad->ctx_mask + 1));
+  }
+  ad->num_ctx = 0;
+  ad->live_bits_q16 = 0;
+  memset(ad->bits_q16, 0, sizeof(ad->bits_q16));
+  ad->num_symbols = 0;
+  ad->error = 0;
+}
+
+static int pwdc_adapt_alloc_keys(pwdc_adapt *ad, uint32_t size) {
+  const void **keys = (const void **)calloc(size, sizeof(*keys));
+  uint32_t *ids = (uint32_t *)malloc(sizeof(*ids) * size);
+  if (keys == NULL || ids == NULL) {
+    free(keys);
+    free(ids);
+    return -1;
+  }
+  /*Rehash the existing entries.*/
+  for (uint32_t i = 0; ad->ctx_keys != NULL && i <= ad->ctx_mask; i++) {
+    if (ad->ctx_keys[i] == NULL) continue;
+    uint32_t h = ((uint32_t)((uintptr_t)ad->ctx_keys[i] >> 1) * 0x9E3779B1U) &
+                 (size - 1);
+    while (keys[h] != NULL) h = (h + 1) & (size - 1);
+    keys[h] = ad->ctx_keys[i];
+    ids[h] = ad->ctx_ids[i];
+  }
+  free(ad->ctx_keys);
+  free(ad->ctx_ids);
+  ad->ctx_keys = keys;
+  ad->ctx_ids = ids;
+  ad->ctx_mask = size - 1;
+  return 0;
+}
+
+static int pwdc_adapt_alloc_state(pwdc_adapt *ad, uint32_t num_ctx) {
+  const size_t row_size = sizeof(*ad->rows) * PWDC_ADAPT_LANES * ad->num_rows;
+  uint16_t *rows = (uint16_t *)realloc(ad->rows, row_size * num_ctx);
+  if (rows == NULL) return -1;
+  ad->rows = rows;
+  uint16_t *counts =
+      (uint16_t *)realloc(ad->counts, sizeof(*counts) * num_ctx);
+  if (counts == NULL) return -1;
+  ad->counts = counts;
+  ad->ctx_alloc = num_ctx;
+  return 0;
+}
+
+/*Returns the index of the context for cdf, seeding its models from cdf the
+   first time, or -1 on allocation failure.*/
+static int64_t pwdc_adapt_context(pwdc_adapt *ad, const aom_cdf_prob *cdf,
+                                  int nsyms) {
+  if (ad->ctx_keys == NULL && pwdc_adapt_alloc_keys(ad, PWDC_ADAPT_CTX_INIT)) {
+    return -1;
+  }
+  uint32_t h =
+      ((uint32_t)((uintptr_t)cdf >> 1) * 0x9E3779B1U) & ad->ctx_mask;
+  while (ad->ctx_keys[h] != NULL) {
+    if (ad->ctx_keys[h] == cdf) return ad->ctx_ids[h];
+    h = (h + 1) & ad->ctx_mask;
+  }
+  if (2 * (ad->num_ctx + 1) > ad->ctx_mask + 1) {
+    if (pwdc_adapt_alloc_keys(ad, 2 * (ad->ctx_mask + 1))) return -1;
+    return pwdc_adapt_context(ad, cdf, nsyms);
+  }
+  if (ad->num_ctx == ad->ctx_alloc &&
+      pwdc_adapt_alloc_state(ad, OD_MAXI(2 * ad->ctx_alloc, 256))) {
+    return -1;
+  }
+  const uint32_t id = ad->num_ctx++;
+  ad->ctx_keys[h] = cdf;
+  ad->ctx_ids[h] = id;
+  uint16_t seed[PWDC_ADAPT_LANES] = { 0 };
+  memcpy(seed, cdf, sizeof(*cdf) * nsyms);
+  uint16_t *rows = ad->rows + (size_t)id * ad->num_rows * PWDC_ADAPT_LANES;
+  for (int r = 0; r < ad->num_rows; r++) {
+    memcpy(rows + r * PWDC_ADAPT_LANES, seed, sizeof(seed));
+  }
+  ad->counts[id] = cdf[nsyms];
+  return id;
+}
+
+/*-log2(p / 32768) in Q16, for 0 < p <= 32768.*/
+static uint32_t pwdc_adapt_cost(const pwdc_adapt *ad, unsigned p) {
+  const int n = OD_ILOG_NZ(p) - 1;
+  const unsigned m = ((p << (15 - n)) >> 7) & 0xFF;
+  return ((uint32_t)(15 - n) << 16) - ad->log2_q16[m];
+}
+
+/*The probability of s under an inverse CDF.*/
+static unsigned pwdc_adapt_prob(const uint16_t *icdf, int s) {
+  const unsigned fl = s > 0 ? icdf[s - 1] : CDF_PROB_TOP;
+  return OD_MAXI((int)(fl - icdf[s]), 1);
+}
+
+/*Moves every lane of an inverse CDF 1/2^rate of the way towards the one-hot
+   CDF of s, rounding as update_cdf() does. Lanes at and above nsyms - 1 are
+   zero and stay zero. The values fit in 16 bits unsigned, so this is two
+   8-lane vectors; C's integer promotions keep the compiler from finding that
+   on its own.*/
+#if defined(PWDC_ADAPT_ROW_SSE2)
+static void pwdc_adapt_row(uint16_t *row, int s, int rate) {
+  const __m128i top = _mm_set1_epi16((int16_t)CDF_PROB_TOP);
+  const __m128i sv = _mm_set1_epi16((int16_t)s);
+  const __m128i shift = _mm_cvtsi32_si128(rate);
+  __m128i idx = _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7);
+  for (int i = 0; i < PWDC_ADAPT_LANES; i += 8) {
+    const __m128i c = _mm_loadu_si128((const __m128i *)(row + i));
+    const __m128i up = _mm_srl_epi16(_mm_sub_epi16(top, c), shift);
+    const __m128i down = _mm_srl_epi16(c, shift);
+    const __m128i m = _mm_cmplt_epi16(idx, sv);
+    const __m128i d =
+        _mm_sub_epi16(_mm_and_si128(m, up), _mm_andnot_si128(m, down));
+    _mm_storeu_si128((__m128i *)(row + i), _mm_add_epi16(c, d));
+    idx = _mm_add_epi16(idx, _mm_set1_epi16(8));
+  }
+}
+#elif defined(PWDC_ADAPT_ROW_NEON)
+static void pwdc_adapt_row(uint16_t *row, int s, int rate) {
+  static const uint16_t lanes[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+  const uint16x8_t top = vdupq_n_u16(CDF_PROB_TOP);
+  const uint16x8_t sv = vdupq_n_u16((uint16_t)s);
+  const int16x8_t shift = vdupq_n_s16((int16_t)-rate);
+  uint16x8_t idx = vld1q_u16(lanes);
+  for (int i = 0; i < PWDC_ADAPT_LANES; i += 8) {
+    const uint16x8_t c = vld1q_u16(row + i);
+    const uint16x8_t up = vshlq_u16(vsubq_u16(top, c), shift);
+    const uint16x8_t down = vshlq_u16(c, shift);
+    const uint16x8_t m = vcltq_u16(idx, sv);
+    vst1q_u16(row + i, vbslq_u16(m, vaddq_u16(c, up), vsubq_u16(c, down)));
+    idx = vaddq_u16(idx, vdupq_n_u16(8));
+  }
+}
+#else
+static void pwdc_adapt_row(uint16_t *row, int s, int rate) {
+  for (int i = 0; i < PWDC_ADAPT_LANES; i++) {
+    const uint16_t c = row[i];
+    if (i < s) {
+      row[i] = c + ((uint16_t)(CDF_PROB_TOP - c) >> rate);
+    } else {
+      row[i] = c - (c >> rate);
+    }
+  }
+}
+#endif
+
+void pwdc_adapt_observe(pwdc_adapt *ad, const aom_cdf_prob *cdf, int symb,
+                        int nsyms) {
+  static const int nsymbs2speed[17] = { 0, 0, 1, 1, 2, 2, 2, 2, 2,
+                                        2, 2, 2, 2, 2, 2, 2, 2 };
+  assert(nsyms >= 2 && nsyms <= PWDC_ADAPT_LANES);
+  if (ad->error) return;
+  const int64_t id = pwdc_adapt_context(ad, cdf, nsyms);
+  if (id < 0) {
+    ad->error = -1;
+    return;
+  }
+  uint16_t *rows = ad->rows + (size_t)id * ad->num_rows * PWDC_ADAPT_LANES;
+  const unsigned count = ad->counts[id];
+  ad->live_bits_q16 += pwdc_adapt_cost(ad, pwdc_adapt_prob(cdf, symb));
+  ad->num_symbols++;
+  for (int m = 0; m < ad->num_models; m++) {
+    const pwdc_adapt_model *model = &ad->models[m];
+    uint16_t *row = rows + ad->row[m] * PWDC_ADAPT_LANES;
+    unsigned p;
+    switch (model->kind) {
+      case PWDC_ADAPT_AV1: {
+        const unsigned c = OD_MINI(count, PWDC_ADAPT_AV1_MAX_COUNT);
+        p = pwdc_adapt_prob(row, symb);
+        pwdc_adapt_row(row, symb,
+                       3 + (c > 15) + (c > 31) + nsymbs2speed[nsyms]);
+        break;
+      }
+      case PWDC_ADAPT_FIXED:
+        p = pwdc_adapt_prob(row, symb);
+        pwdc_adapt_row(row, symb, model->rate);
+        break;
+      case PWDC_ADAPT_TWO_SPEED: {
+        uint16_t *slow = row + PWDC_ADAPT_LANES;
+        p = (pwdc_adapt_prob(row, symb) + pwdc_adapt_prob(slow, symb) + 1) >>
+            1;
+        pwdc_adapt_row(row, symb, model->rate);
+        pwdc_adapt_row(slow, symb, model->rate2);
+        break;
+      }
+      case PWDC_ADAPT_COUNT:
+      default:
+        p = pwdc_adapt_prob(row, symb);
+        pwdc_adapt_row(row, symb,
+                       OD_MINI(OD_ILOG_NZ(count + 1), model->rate));
+        break;
+    }
+    ad->bits_q16[m] += pwdc_adapt_cost(ad, p);
+  }
+  ad->counts[id] = (uint16_t)(count + (count < UINT16_MAX));
+}
+
+double pwdc_adapt_bits(const pwdc_adapt *ad, int model) {
+  const uint64_t q16 =
+      model == PWDC_ADAPT_LIVE ? ad->live_bits_q16 : ad->bits_q16[model];
+  return q16 / 65536.0;
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef AOM_AOM_DSP_PWDC_ADAPT_H_
+#define AOM_AOM_DSP_PWDC_ADAPT_H_
+
+#include "aom_dsp/entcode.h"
+#include "aom_dsp/prob.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*CDF adaptation study mode.
+  With a pwdc_adapt attached to an aom_writer (w->ec.adapt, which
+   od_ec_enc_init() clears), every aom_write_symbol() also runs a set of
+   shadow adaptation models alongside the live update_cdf().
+  Each context (one per CDF array) gets its own copy of every model, seeded
+   from the live CDF the first time the context is seen. Before a symbol
+   updates them, its ideal code length, -log2(p), is charged to the live CDF
+   and to each model. The totals give the size each rule would produce,
+   without touching the bitstream.
+  The shadow CDFs are kept in 16 lanes per context, so each update is one
+   fixed-length, branch-free loop over the lanes that the compiler turns into
+   vector code.*/
+
+typedef enum {
+  /*update_cdf() itself: with allow_update_cdf set it matches the live CDF
+     exactly, otherwise it shows what adaptation would have bought.*/
+  PWDC_ADAPT_AV1,
+  /*A constant rate: each update moves 1/2^rate of the way.*/
+  PWDC_ADAPT_FIXED,
+  /*Two CDFs at a fast and a slow rate, coded with their average.*/
+  PWDC_ADAPT_TWO_SPEED,
+  /*Rate grows with the context's symbol count, approximating a frequency
+     count early on, up to a cap.*/
+  PWDC_ADAPT_COUNT,
+} pwdc_adapt_kind;
+
+typedef struct {
+  pwdc_adapt_kind kind;
+  /*FIXED: the rate. TWO_SPEED: the fast rate. COUNT: the largest rate.*/
+  int rate;
+  /*TWO_SPEED: the slow rate.*/
+  int rate2;
+} pwdc_adapt_model;
+
+#define PWDC_ADAPT_MAX_MODELS (4)
+/*Lanes per shadow CDF: the largest alphabet AV1 codes.*/
+#define PWDC_ADAPT_LANES (16)
+/*Pass as the model to pwdc_adapt_bits() for the live CDF.*/
+#define PWDC_ADAPT_LIVE (-1)
+
+typedef struct pwdc_adapt pwdc_adapt;
+
+struct pwdc_adapt {
+  pwdc_adapt_model models[PWDC_ADAPT_MAX_MODELS];
+  int num_models;
+  /*Shadow CDF rows per context, and the first row of each model.*/
+  int num_rows;
+  int row[PWDC_ADAPT_MAX_MODELS];
+  /*Context hash table: CDF pointer to context index.*/
+  const void **ctx_keys;
+  uint32_t *ctx_ids;
+  uint32_t ctx_mask;
+  uint32_t num_ctx;
+  uint32_t ctx_alloc;
+  /*num_rows rows of PWDC_ADAPT_LANES per context.*/
+  uint16_t *rows;
+  /*Symbols seen per context, saturating.*/
+  uint16_t *counts;
+  /*log2(1 + i/256) in Q16, for the code lengths.*/
+  uint32_t log2_q16[256];
+  /*Ideal code lengths so far, in 1/65536 bit.*/
+  uint64_t live_bits_q16;
+  uint64_t bits_q16[PWDC_ADAPT_MAX_MODELS];
+  uint64_t num_symbols;
+  int error;
+};
+
+/*Sets up num_models shadow models. Returns 0 on success.*/
+int pwdc_adapt_init(pwdc_adapt *ad, const pwdc_adapt_model *models,
+                    int num_models) OD_ARG_NONNULL(1) OD_ARG_NONNULL(2);
+void pwdc_adapt_clear(pwdc_adapt *ad) OD_ARG_NONNULL(1);
+/*Forgets all contexts and totals, e.g. when the live CDFs are reloaded at a
+   frame boundary.*/
+void pwdc_adapt_reset(pwdc_adapt *ad) OD_ARG_NONNULL(1);
+
+/*Charges symb, about to be coded with cdf, to every model and updates them.
+  Call before the live CDF adapts.*/
+void pwdc_adapt_observe(pwdc_adapt *ad, const aom_cdf_prob *cdf, int symb,
+                        int nsyms) OD_ARG_NONNULL(1) OD_ARG_NONNULL(2);
+
+/*The total ideal code length of a model, or of the live CDF, in bits.*/
+OD_WARN_UNUSED_RESULT double pwdc_adapt_bits(const pwdc_adapt *ad, int model)
+    OD_ARG_NONNULL(1);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_AOM_DSP_PWDC_ADAPT_H_
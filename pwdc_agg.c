@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aom_dsp/pwdc_agg.h"
+#include "aom_mem/aom_mem.h"
+#include "aom_ports/mem.h"
+
+#define PWDC_AGG_ALIGN (64)
+/*pwdc_stats is all uint64_t, so a shard holds it as an array.*/
+#define PWDC_AGG_FIELDS ((int)(sizeof(pwdc_stats) / sizeof(uint64_t)))
+#define PWDC_AGG_MAX_FIELD \
+  ((int)(offsetof(pwdc_stats, carry_max_run) / sizeof(uint64_t)))
+
+/*A merge increments begin, adds its values, then increments end. A reader
+   that finds begin == end before and the same begin after reading the values
+   has seen only complete merges. Both are 64-bit and never wrap in practice.
+  Each shard starts on its own cache line; the shard size is rounded up to
+   the line as well.*/
+typedef struct {
+  DECLARE_ALIGNED(PWDC_AGG_ALIGN, atomic_uint_fast64_t, begin);
+  atomic_uint_fast64_t end;
+  atomic_uint_fast64_t v[PWDC_AGG_FIELDS];
+} pwdc_agg_shard;
+
+struct pwdc_agg {
+  pwdc_agg_shard *shards;
+  int num_shards;
+};
+
+/*Per-thread index, 1-based so 0 means not yet assigned. Shared by every
+   aggregator, so a thread lands on the same shard of each one.*/
+static atomic_int g_pwdc_agg_next_thread = 0;
+static OD_EC_THREAD_LOCAL int g_pwdc_agg_thread = 0;
+
+pwdc_agg *pwdc_agg_create(int num_shards) {
+  pwdc_agg *agg = (pwdc_agg *)calloc(1, sizeof(*agg));
+  if (agg == NULL) return NULL;
+  agg->num_shards = num_shards > 1 ? num_shards : 1;
+  agg->shards = (pwdc_agg_shard *)aom_memalign(
+      PWDC_AGG_ALIGN, sizeof(*agg->shards) * agg->num_shards);
+  if (agg->shards == NULL) {
+    free(agg);
+    return NULL;
+  }
+  for (int s = 0; s < agg->num_shards; s++) {
+    pwdc_agg_shard *shard = &agg->shards[s];
+    atomic_init(&shard->begin, 0);
+    atomic_init(&shard->end, 0);
+    for (int i = 0; i < PWDC_AGG_FIELDS; i++) atomic_init(&shard->v[i], 0);
+  }
+  return agg;
+}
+
+void pwdc_agg_destroy(pwdc_agg *agg) {
+  if (agg == NULL) return;
+  aom_free(agg->shards);
+  free(agg);
+}
+
+static pwdc_agg_shard *pwdc_agg_thread_shard(pwdc_agg *agg) {
+  if (g_pwdc_agg_thread == 0) {
+    g_pwdc_agg_thread = atomic_fetch_add_explicit(&g_pwdc_agg_next_thread, 1,
+                                                  memory_order_relaxed) +
+                        1;
+  }
+  return &agg->shards[(unsigned)(g_pwdc_agg_thread - 1) % agg->num_shards];
+}
+
+void pwdc_agg_merge(pwdc_agg *agg, const pwdc_stats *stats) {
+  pwdc_agg_shard *shard = pwdc_agg_thread_shard(agg);
+  uint64_t v[PWDC_AGG_FIELDS];
+  memcpy(v, stats, sizeof(v));
+  atomic_fetch_add_explicit(&shard->begin, 1, memory_order_relaxed);
+  /*The values are released, so a reader that sees any of them also sees
+     begin move. On x86 this costs nothing over relaxed.*/
+  for (int i = 0; i < PWDC_AGG_FIELDS; i++) {
+    if (v[i] == 0) continue;
+    if (i == PWDC_AGG_MAX_FIELD) {
+      uint64_t cur = atomic_load_explicit(&shard->v[i], memory_order_relaxed);
+      while (cur < v[i] &&
+             !atomic_compare_exchange_weak_explicit(&shard->v[i], &cur, v[i],
+                                                    memory_order_release,
+                                                    memory_order_relaxed)) {
+      }
+      continue;
+    }
+    atomic_fetch_add_explicit(&shard->v[i], v[i], memory_order_release);
+  }
+  atomic_fetch_add_explicit(&shard->end, 1, memory_order_release);
+}
+
+void pwdc_agg_merge_thread(pwdc_agg *agg) {
+  pwdc_stats stats;
+  pwdc_stats_get(&stats);
+  pwdc_agg_merge(agg, &stats);
+  pwdc_stats_reset();
+}
+
+/*Reads one shard's values as of a point with no merge in flight. Merges are
+   rare (one per tile or frame) next to the time a copy takes, so retries are
+   too.*/
+static void pwdc_agg_read_shard(pwdc_agg_shard *shard,
+                                uint64_t v[PWDC_AGG_FIELDS]) {
+  for (;;) {
+    const uint64_t end =
+        atomic_load_explicit(&shard->end, memory_order_acquire);
+    const uint64_t begin =
+        atomic_load_explicit(&shard->begin, memory_order_relaxed);
+    if (begin != end) continue;
+    for (int i = 0; i < PWDC_AGG_FIELDS; i++) {
+      v[i] = atomic_load_explicit(&shard->v[i], memory_order_acquire);
+    }
+    if (atomic_load_explicit(&shard->begin, memory_order_relaxed) == begin) {
+      return;
+    }
+  }
+}
+
+void pwdc_agg_snapshot(pwdc_agg *agg, pwdc_stats *stats) {
+  uint64_t total[PWDC_AGG_FIELDS] = { 0 };
+  uint64_t v[PWDC_AGG_FIELDS];
+  for (int s = 0; s < agg->num_shards; s++) {
+    pwdc_agg_read_shard(&agg->shards[s], v);
+    for (int i = 0; i < PWDC_AGG_FIELDS; i++) {
+      if (i == PWDC_AGG_MAX_FIELD) {
+        total[i] = total[i] > v[i] ? total[i] : v[i];
+      } else {
+        total[i] += v[i];
+      }
+    }
+  }
+  memcpy(stats, total, sizeof(total));
+}
+
+void pwdc_agg_reset(pwdc_agg *agg) {
+  for (int s = 0; s < agg->num_shards; s++) {
+    pwdc_agg_shard *shard = &agg->shards[s];
+    for (int i = 0; i < PWDC_AGG_FIELDS; i++) {
+      atomic_store_explicit(&shard->v[i], 0, memory_order_relaxed);
+    }
+  }
+}
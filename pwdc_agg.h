@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef AOM_AOM_DSP_PWDC_AGG_H_
+#define AOM_AOM_DSP_PWDC_AGG_H_
+
+#include "aom_dsp/entenc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*Process-wide PWDC statistics combined from many threads.
+  pwdc_stats are per thread. A pwdc_agg sums them across threads without
+   locks: each thread merges into one of a set of cache-line-aligned shards,
+   chosen by a per-thread index handed out on the thread's first merge, so
+   threads only share a shard when there are more threads than shards.
+  A merge adds a whole pwdc_stats to its shard with relaxed atomic adds,
+   bracketed by two per-shard sequence counters. A snapshot reads each shard
+   between those counters and retries a shard whose merge was in flight, so
+   it sees every merge either completely or not at all (total_symbols always
+   equals the sum of channel_hits, for example) and never blocks a merge.
+  Requires C11 atomics.*/
+
+typedef struct pwdc_agg pwdc_agg;
+
+/*Creates an aggregator with num_shards shards, at least 1; the number of
+   threads that merge concurrently is a good choice. Returns NULL on
+   allocation failure.*/
+pwdc_agg *pwdc_agg_create(int num_shards);
+void pwdc_agg_destroy(pwdc_agg *agg);
+
+/*Adds stats to the totals. carry_max_run is combined with max(). Safe to
+   call from any number of threads at once.*/
+void pwdc_agg_merge(pwdc_agg *agg, const pwdc_stats *stats)
+    OD_ARG_NONNULL(1) OD_ARG_NONNULL(2);
+/*Moves the calling thread's statistics into the totals: pwdc_stats_get(),
+   pwdc_agg_merge(), then pwdc_stats_reset() (which also clears per-context
+   counts).*/
+void pwdc_agg_merge_thread(pwdc_agg *agg) OD_ARG_NONNULL(1);
+
+/*Copies out the totals of every merge so far. Safe to call while other
+   threads merge.*/
+void pwdc_agg_snapshot(pwdc_agg *agg, pwdc_stats *stats) OD_ARG_NONNULL(1)
+    OD_ARG_NONNULL(2);
+/*Clears the totals. Must not run concurrently with merges.*/
+void pwdc_agg_reset(pwdc_agg *agg) OD_ARG_NONNULL(1);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_AOM_DSP_PWDC_AGG_H_
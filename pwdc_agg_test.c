@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+/*pwdc_agg_test: concurrent merges and snapshots of a pwdc_agg (see
+   pwdc_agg.h). Meant to be run under ThreadSanitizer as well.
+  Usage: pwdc_agg_test [num_threads]
+  First a tile pool with num_threads workers (default 16) codes frames into
+   an aggregator while another thread snapshots it, and the totals must
+   equal the statistics of the same tiles coded on one thread. Then more
+   threads than there are shards merge known statistics, again under
+   snapshots, and the totals must be exact.
+  Every snapshot must be consistent (total_symbols equal to the bools plus
+   the channel hits) and total_symbols must never go down.*/
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aom_dsp/entenc_mt.h"
+#include "aom_dsp/pwdc_agg.h"
+
+#define PWDC_AGG_TEST_TILES (64)
+#define PWDC_AGG_TEST_FRAMES (4)
+#define PWDC_AGG_TEST_MERGERS (24)
+#define PWDC_AGG_TEST_MERGES (20000)
+
+typedef struct {
+  pwdc_agg *agg;
+  atomic_int stop;
+  long snapshots;
+  long bad;
+} pwdc_agg_test_reader;
+
+typedef struct {
+  pwdc_agg *agg;
+  int id;
+} pwdc_agg_test_merger;
+
+static uint32_t pwdc_agg_test_rand(uint32_t *seed) {
+  *seed = *seed * 1103515245 + 12345;
+  return *seed >> 8;
+}
+
+static int pwdc_agg_test_consistent(const pwdc_stats *s) {
+  uint64_t sum = s->bool_count[0] + s->bool_count[1];
+  for (int i = 0; i < 128; i++) sum += s->channel_hits[i];
+  return sum == s->total_symbols;
+}
+
+static void *pwdc_agg_test_read(void *arg) {
+  pwdc_agg_test_reader *r = (pwdc_agg_test_reader *)arg;
+  uint64_t last = 0;
+  do {
+    pwdc_stats s;
+    pwdc_agg_snapshot(r->agg, &s);
+    r->snapshots++;
+    if (!pwdc_agg_test_consistent(&s) || s.total_symbols < last) r->bad++;
+    last = s.total_symbols;
+  } while (!atomic_load(&r->stop));
+  return NULL;
+}
+
+static int pwdc_agg_test_tile(void *priv, int tile_idx, aom_writer *w) {
+  aom_cdf_prob cdf[CDF_SIZE(4)] = { AOM_CDF4(8192, 16384, 24576) };
+  uint32_t seed = 7 * tile_idx + 1;
+  const int n = 2000 + (tile_idx * 977) % 20000;
+  (void)priv;
+  for (int i = 0; i < n; i++) {
+    if (pwdc_agg_test_rand(&seed) & 1) {
+      const int bit = pwdc_agg_test_rand(&seed) % 3 == 0;
+      aom_write(w, bit, 1 + pwdc_agg_test_rand(&seed) % 255);
+    } else {
+      aom_write_symbol(w, pwdc_agg_test_rand(&seed) % 4, cdf, 4);
+    }
+  }
+  return 0;
+}
+
+static void *pwdc_agg_test_merge(void *arg) {
+  const pwdc_agg_test_merger *m = (const pwdc_agg_test_merger *)arg;
+  for (int i = 0; i < PWDC_AGG_TEST_MERGES; i++) {
+    pwdc_stats s;
+    memset(&s, 0, sizeof(s));
+    s.channel_hits[(m->id + i) & 127] = i + 1;
+    s.bool_count[i & 1] = m->id;
+    s.total_symbols = i + 1 + m->id;
+    s.carry_max_run = 3 * m->id + (i & 7);
+    pwdc_agg_merge(m->agg, &s);
+  }
+  return NULL;
+}
+
+static int pwdc_agg_test_check_reader(const char *name,
+                                      const pwdc_agg_test_reader *r) {
+  if (r->bad > 0) {
+    fprintf(stderr, "%s: %ld of %ld snapshots inconsistent\n", name, r->bad,
+            r->snapshots);
+    return -1;
+  }
+  return 0;
+}
+
+/*Returns 0 if the statistics of every tile reached agg.*/
+static int pwdc_agg_test_pool(int num_threads) {
+  pwdc_agg_test_reader r;
+  pthread_t reader;
+  pwdc_stats total;
+  pwdc_stats ref;
+  od_ec_tile_pool *pool = od_ec_tile_pool_create(num_threads);
+  od_ec_tile_pool *serial = od_ec_tile_pool_create(1);
+  int ret = -1;
+  r.agg = pwdc_agg_create(num_threads);
+  atomic_init(&r.stop, 0);
+  r.snapshots = 0;
+  r.bad = 0;
+  if (pool == NULL || serial == NULL || r.agg == NULL) goto done;
+  od_ec_tile_pool_set_stats(pool, r.agg);
+  pwdc_stats_reset();
+  if (pthread_create(&reader, NULL, pwdc_agg_test_read, &r)) goto done;
+  int failed = 0;
+  for (int f = 0; f < PWDC_AGG_TEST_FRAMES && !failed; f++) {
+    failed = od_ec_tile_pool_encode(pool, PWDC_AGG_TEST_TILES, NULL,
+                                    pwdc_agg_test_tile, NULL);
+  }
+  atomic_store(&r.stop, 1);
+  pthread_join(reader, NULL);
+  if (failed) {
+    fprintf(stderr, "pool: coding failed\n");
+    goto done;
+  }
+  pwdc_agg_snapshot(r.agg, &total);
+  /*The same tiles on this thread alone, with no aggregator.*/
+  pwdc_stats_reset();
+  for (int f = 0; f < PWDC_AGG_TEST_FRAMES; f++) {
+    if (od_ec_tile_pool_encode(serial, PWDC_AGG_TEST_TILES, NULL,
+                               pwdc_agg_test_tile, NULL)) {
+      goto done;
+    }
+  }
+  pwdc_stats_get(&ref);
+  if (pwdc_agg_test_check_reader("pool", &r)) goto done;
+  if (memcmp(&total, &ref, sizeof(ref))) {
+    fprintf(stderr, "pool: %llu symbols aggregated, %llu coded\n",
+            (unsigned long long)total.total_symbols,
+            (unsigned long long)ref.total_symbols);
+    goto done;
+  }
+  ret = 0;
+done:
+  pwdc_agg_destroy(r.agg);
+  od_ec_tile_pool_destroy(pool);
+  od_ec_tile_pool_destroy(serial);
+  return ret;
+}
+
+/*More threads than shards, so shards are shared.*/
+static int pwdc_agg_test_shared_shards(void) {
+  pwdc_agg_test_reader r;
+  pwdc_agg_test_merger m[PWDC_AGG_TEST_MERGERS];
+  pthread_t threads[PWDC_AGG_TEST_MERGERS];
+  pthread_t reader;
+  pwdc_stats total;
+  uint64_t want = 0;
+  int num_started = 0;
+  int ret = -1;
+  r.agg = pwdc_agg_create(4);
+  atomic_init(&r.stop, 0);
+  r.snapshots = 0;
+  r.bad = 0;
+  if (r.agg == NULL) return -1;
+  if (pthread_create(&reader, NULL, pwdc_agg_test_read, &r)) goto done;
+  for (int i = 0; i < PWDC_AGG_TEST_MERGERS; i++) {
+    m[i].agg = r.agg;
+    m[i].id = i;
+    if (pthread_create(&threads[i], NULL, pwdc_agg_test_merge, &m[i])) break;
+    num_started++;
+  }
+  for (int i = 0; i < num_started; i++) pthread_join(threads[i], NULL);
+  atomic_store(&r.stop, 1);
+  pthread_join(reader, NULL);
+  if (num_started < PWDC_AGG_TEST_MERGERS) goto done;
+  if (pwdc_agg_test_check_reader("shared shards", &r)) goto done;
+  pwdc_agg_snapshot(r.agg, &total);
+  for (int i = 0; i < PWDC_AGG_TEST_MERGERS; i++) {
+    want += (uint64_t)PWDC_AGG_TEST_MERGES * (PWDC_AGG_TEST_MERGES + 1) / 2 +
+            (uint64_t)i * PWDC_AGG_TEST_MERGES;
+  }
+  if (total.total_symbols != want) {
+    fprintf(stderr, "shared shards: %llu symbols, expected %llu\n",
+            (unsigned long long)total.total_symbols,
+            (unsigned long long)want);
+    goto done;
+  }
+  if (total.carry_max_run != 3 * (PWDC_AGG_TEST_MERGERS - 1) + 7) {
+    fprintf(stderr, "shared shards: carry_max_run %llu, expected %d\n",
+            (unsigned long long)total.carry_max_run,
+            3 * (PWDC_AGG_TEST_MERGERS - 1) + 7);
+    goto done;
+  }
+  ret = 0;
+done:
+  pwdc_agg_destroy(r.agg);
+  return ret;
+}
+
+int main(int argc, char **argv) {
+  const int num_threads = argc > 1 ? atoi(argv[1]) : 16;
+  if (num_threads < 1) {
+    fprintf(stderr, "Usage: %s [num_threads]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (pwdc_agg_test_pool(num_threads)) return EXIT_FAILURE;
+  if (pwdc_agg_test_shared_shards()) return EXIT_FAILURE;
+  printf("pwdc_agg_test: OK\n");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+/*pwdc_budget_test: the byte budget of od_ec_enc_set_budget(), directly and
+   through an od_ec_pipe. Meant to be run under ThreadSanitizer as well.
+  Usage: pwdc_budget_test
+  Codes random bools, equiprobable bits and CDF symbols twice per seed and budget,
+   once with the budget set and once without, and checks that:
+  - the output is the same either way, and nothing is flagged without a
+     budget;
+  - the flag is never raised before od_ec_enc_tell() passes the budget, and
+     at most one flush late;
+  - it is set after od_ec_enc_done() exactly when tell passed the budget;
+  - od_ec_enc_reset() clears it.
+  Then writes through a pipe while polling od_ec_pipe_over_budget(), which
+   must never report the budget passed before the encoder does.*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aom_dsp/bitwriter.h"
+
+#define PWDC_BUDGET_TEST_SYMBOLS (3000)
+/*How far past the budget tell can be when the flag is first seen: the flush
+   that raises it sees tell from before the symbol that triggered it, and the
+   flush before that was just under the budget. That is up to a flush's worth
+   of bits plus two symbols, each under 16 bits.*/
+#define PWDC_BUDGET_TEST_MAX_LATE (OD_EC_ENC_FLUSH_BITS + 2 * 16)
+
+static const uint16_t pwdc_budget_test_icdf[4] = { 24000, 16000, 8000, 0 };
+
+static uint32_t pwdc_budget_test_rand(uint32_t *seed) {
+  *seed = *seed * 1103515245 + 12345;
+  return *seed >> 8;
+}
+
+/*Codes n random symbols into enc. Returns od_ec_enc_tell() right after the
+   flag was first seen, or -1 if it never was.*/
+static int pwdc_budget_test_code(od_ec_enc *enc, uint32_t seed, int n) {
+  int flag_tell = -1;
+  for (int i = 0; i < n; i++) {
+    const uint32_t r = pwdc_budget_test_rand(&seed);
+    if (r & 1) {
+      od_ec_encode_bool_q15(enc, (r >> 1) & 1, 1 + (r >> 3) % 32767);
+    } else if (r & 2) {
+      od_ec_encode_bool_half(enc, (r >> 4) & 1);
+    } else {
+      od_ec_encode_cdf_q15(enc, (r >> 4) & 3, pwdc_budget_test_icdf, 4);
+    }
+    if (flag_tell < 0 && od_ec_enc_over_budget(enc)) {
+      flag_tell = od_ec_enc_tell(enc);
+    }
+  }
+  return flag_tell;
+}
+
+static int pwdc_budget_test_direct(void) {
+  od_ec_enc ref;
+  od_ec_enc enc;
+  int ret = -1;
+  od_ec_enc_init(&ref, 16);
+  od_ec_enc_init(&enc, 16);
+  for (uint32_t budget = 1; budget < 5000; budget += budget < 64 ? 1 : 37) {
+    od_ec_enc_set_budget(&enc, budget);
+    for (uint32_t seed = 1; seed < 6; seed++) {
+      uint32_t ref_size;
+      uint32_t size;
+      const int ref_flag_tell =
+          pwdc_budget_test_code(&ref, seed, PWDC_BUDGET_TEST_SYMBOLS);
+      const int flag_tell =
+          pwdc_budget_test_code(&enc, seed, PWDC_BUDGET_TEST_SYMBOLS);
+      const int over = od_ec_enc_tell(&enc) > (int)budget * 8;
+      const unsigned char *ref_out = od_ec_enc_done(&ref, &ref_size);
+      const unsigned char *out = od_ec_enc_done(&enc, &size);
+      if (ref_out == NULL || out == NULL) {
+        fprintf(stderr, "budget %u: coding failed\n", budget);
+        goto done;
+      }
+      if (size != ref_size || memcmp(out, ref_out, size)) {
+        fprintf(stderr, "budget %u: output differs from no budget\n", budget);
+        goto done;
+      }
+      if (ref_flag_tell >= 0 || od_ec_enc_over_budget(&ref)) {
+        fprintf(stderr, "budget %u: flagged without a budget\n", budget);
+        goto done;
+      }
+      if (flag_tell >= 0 && flag_tell <= (int)budget * 8) {
+        fprintf(stderr, "budget %u: flagged early, at %d bits\n", budget,
+                flag_tell);
+        goto done;
+      }
+      if (flag_tell > (int)budget * 8 + PWDC_BUDGET_TEST_MAX_LATE) {
+        fprintf(stderr, "budget %u: flagged late, at %d bits\n", budget,
+                flag_tell);
+        goto done;
+      }
+      if (od_ec_enc_over_budget(&enc) != over) {
+        fprintf(stderr, "budget %u: flag %d after done, expected %d\n",
+                budget, od_ec_enc_over_budget(&enc), over);
+        goto done;
+      }
+      od_ec_enc_reset(&ref);
+      od_ec_enc_reset(&enc);
+      if (od_ec_enc_over_budget(&enc)) {
+        fprintf(stderr, "budget %u: flag kept across a reset\n", budget);
+        goto done;
+      }
+    }
+  }
+  ret = 0;
+done:
+  od_ec_enc_clear(&ref);
+  od_ec_enc_clear(&enc);
+  return ret;
+}
+
+static int pwdc_budget_test_pipe(void) {
+  od_ec_pipe *pipe = od_ec_pipe_create();
+  od_ec_symbuf sb;
+  aom_writer w;
+  od_ec_enc ref;
+  int ret = -1;
+  memset(&w, 0, sizeof(w));
+  od_ec_enc_init(&w.ec, 1024);
+  od_ec_enc_init(&ref, 1024);
+  od_ec_symbuf_init(&sb);
+  if (pipe == NULL) goto done;
+  for (uint32_t budget = 256; budget < 65536; budget *= 2) {
+    uint32_t seed = budget;
+    uint32_t size;
+    od_ec_enc_reset(&w.ec);
+    od_ec_enc_reset(&ref);
+    od_ec_enc_set_budget(&w.ec, budget);
+    od_ec_enc_set_budget(&ref, budget);
+    od_ec_pipe_begin(pipe, &sb, &w.ec);
+    for (int i = 0; i < 200000; i++) {
+      const uint32_t r = pwdc_budget_test_rand(&seed);
+      const int bit = (r >> 1) & 1;
+      const int p = 1 + (int)(r >> 8) % 255;
+      aom_write(&w, bit, p);
+      od_ec_encode_bool_q15(&ref, bit, od_ec_prob8_q15[p]);
+      /*The pipe can trail the encoder coding the same bools directly, but
+         never lead it.*/
+      if (od_ec_pipe_over_budget(pipe) && !od_ec_enc_over_budget(&ref)) {
+        fprintf(stderr, "pipe budget %u: flagged early at symbol %d\n",
+                budget, i);
+        od_ec_pipe_finish(pipe);
+        goto done;
+      }
+    }
+    if (od_ec_pipe_finish(pipe) || od_ec_enc_done(&w.ec, &size) == NULL ||
+        od_ec_enc_done(&ref, &size) == NULL) {
+      fprintf(stderr, "pipe budget %u: coding failed\n", budget);
+      goto done;
+    }
+    if (od_ec_enc_over_budget(&w.ec) != od_ec_enc_over_budget(&ref)) {
+      fprintf(stderr, "pipe budget %u: flag %d after done, expected %d\n",
+              budget, od_ec_enc_over_budget(&w.ec),
+              od_ec_enc_over_budget(&ref));
+      goto done;
+    }
+  }
+  ret = 0;
+done:
+  od_ec_pipe_destroy(pipe);
+  od_ec_symbuf_clear(&sb);
+  od_ec_enc_clear(&ref);
+  od_ec_enc_clear(&w.ec);
+  return ret;
+}
+
+int main(void) {
+  if (pwdc_budget_test_direct()) return EXIT_FAILURE;
+  if (pwdc_budget_test_pipe()) return EXIT_FAILURE;
+  printf("pwdc_budget_test: OK\n");
+  return EXIT_SUCCESS;
+}
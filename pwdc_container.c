@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <string.h>
+
+#include "aom/aom_integer.h"
+#include "aom_dsp/pwdc_container.h"
+
+static uint64_t pwdc_container_data_size(const pwdc_container_blob *tables,
+                                         uint32_t num_tables,
+                                         const pwdc_container_blob *substreams,
+                                         uint32_t num_substreams) {
+  uint64_t total = 0;
+  for (uint32_t i = 0; i < num_tables; i++) total += tables[i].nbytes;
+  for (uint32_t i = 0; i < num_substreams; i++) total += substreams[i].nbytes;
+  return total;
+}
+
+/*The fewest bytes that hold every offset into a data area of this size.*/
+static int pwdc_container_width(uint64_t data_size) {
+  int width = 1;
+  while (width < 4 && data_size >> (8 * width) != 0) width++;
+  return width;
+}
+
+static uint64_t pwdc_container_header_size(uint32_t num_tables,
+                                           uint32_t num_substreams,
+                                           int width) {
+  return 1 + aom_uleb_size_in_bytes(num_tables) +
+         aom_uleb_size_in_bytes(num_substreams) +
+         ((uint64_t)num_tables + num_substreams) * width +
+         ((uint64_t)num_substreams + 3) / 4;
+}
+
+int64_t pwdc_container_size(const pwdc_container_blob *tables,
+                            uint32_t num_tables,
+                            const pwdc_container_blob *substreams,
+                            uint32_t num_substreams) {
+  const uint64_t data_size = pwdc_container_data_size(
+      tables, num_tables, substreams, num_substreams);
+  if (data_size > UINT32_MAX) return -1;
+  return (int64_t)(pwdc_container_header_size(
+                       num_tables, num_substreams,
+                       pwdc_container_width(data_size)) +
+                   data_size);
+}
+
+static unsigned char *pwdc_container_put_offset(unsigned char *p,
+                                                uint64_t offset, int width) {
+  for (int b = 0; b < width; b++) *p++ = (unsigned char)(offset >> (8 * b));
+  return p;
+}
+
+int64_t pwdc_container_write(unsigned char *dst, size_t dst_size,
+                             const pwdc_container_blob *tables,
+                             uint32_t num_tables,
+                             const pwdc_container_blob *substreams,
+                             const pwdc_coder *coders,
+                             uint32_t num_substreams) {
+  const int64_t total =
+      pwdc_container_size(tables, num_tables, substreams, num_substreams);
+  if (total < 0 || (uint64_t)total > dst_size) return -1;
+  const uint64_t data_size = pwdc_container_data_size(
+      tables, num_tables, substreams, num_substreams);
+  const int width = pwdc_container_width(data_size);
+  unsigned char *p = dst;
+  size_t len;
+  *p++ = (unsigned char)(PWDC_CONTAINER_VERSION << 4 | (width - 1));
+  if (aom_uleb_encode(num_tables, dst_size - (p - dst), p, &len)) return -1;
+  p += len;
+  if (aom_uleb_encode(num_substreams, dst_size - (p - dst), p, &len)) {
+    return -1;
+  }
+  p += len;
+  uint64_t end = 0;
+  for (uint32_t i = 0; i < num_tables; i++) {
+    end += tables[i].nbytes;
+    p = pwdc_container_put_offset(p, end, width);
+  }
+  for (uint32_t i = 0; i < num_substreams; i++) {
+    end += substreams[i].nbytes;
+    p = pwdc_container_put_offset(p, end, width);
+  }
+  memset(p, 0, (num_substreams + 3) / 4);
+  for (uint32_t i = 0; i < num_substreams; i++) {
+    if (coders[i] != PWDC_CODER_RANGE && coders[i] != PWDC_CODER_HUFF) {
+      return -1;
+    }
+    p[i >> 2] |= (unsigned char)(coders[i] << (2 * (i & 3)));
+  }
+  p += (num_substreams + 3) / 4;
+  for (uint32_t i = 0; i < num_tables; i++) {
+    if (tables[i].nbytes > 0) memcpy(p, tables[i].data, tables[i].nbytes);
+    p += tables[i].nbytes;
+  }
+  for (uint32_t i = 0; i < num_substreams; i++) {
+    if (substreams[i].nbytes > 0) {
+      memcpy(p, substreams[i].data, substreams[i].nbytes);
+    }
+    p += substreams[i].nbytes;
+  }
+  return total;
+}
+
+int pwdc_container_open(pwdc_container *c, const unsigned char *buf,
+                        size_t size) {
+  uint64_t num_tables;
+  uint64_t num_substreams;
+  size_t len;
+  memset(c, 0, sizeof(*c));
+  if (buf == NULL || size < 1) return -1;
+  if (buf[0] >> 4 != PWDC_CONTAINER_VERSION || (buf[0] & 0x0C) != 0) {
+    return -1;
+  }
+  const int width = (buf[0] & 3) + 1;
+  size_t pos = 1;
+  if (aom_uleb_decode(buf + pos, size - pos, &num_tables, &len)) return -1;
+  pos += len;
+  if (aom_uleb_decode(buf + pos, size - pos, &num_substreams, &len)) {
+    return -1;
+  }
+  pos += len;
+  if (num_tables > UINT32_MAX || num_substreams > UINT32_MAX) return -1;
+  /*At most 2^33 entries of 4 bytes, so none of this overflows.*/
+  const uint64_t index_size = (num_tables + num_substreams) * width;
+  const uint64_t coder_size = (num_substreams + 3) / 4;
+  if (index_size + coder_size > size - pos) return -1;
+  c->offsets = buf + pos;
+  c->coders = c->offsets + index_size;
+  c->data = c->coders + coder_size;
+  c->data_size = size - pos - (size_t)(index_size + coder_size);
+  c->num_tables = (uint32_t)num_tables;
+  c->num_substreams = (uint32_t)num_substreams;
+  c->width = width;
+  return 0;
+}
+
+static uint32_t pwdc_container_get_offset(const pwdc_container *c,
+                                          uint64_t k) {
+  const unsigned char *p = c->offsets + k * c->width;
+  uint32_t offset = 0;
+  for (int b = 0; b < c->width; b++) offset |= (uint32_t)p[b] << (8 * b);
+  return offset;
+}
+
+/*Locates entry k of the data area, checking it lies inside.*/
+static int pwdc_container_entry(const pwdc_container *c, uint64_t k,
+                                const unsigned char **data,
+                                uint32_t *nbytes) {
+  const uint32_t start = k > 0 ? pwdc_container_get_offset(c, k - 1) : 0;
+  const uint32_t end = pwdc_container_get_offset(c, k);
+  if (start > end || end > c->data_size) return -1;
+  *data = c->data + start;
+  *nbytes = end - start;
+  return 0;
+}
+
+int pwdc_container_substream(const pwdc_container *c, uint32_t i,
+                             const unsigned char **data, uint32_t *nbytes,
+                             pwdc_coder *coder) {
+  if (i >= c->num_substreams) return -1;
+  const int code = (c->coders[i >> 2] >> (2 * (i & 3))) & 3;
+  if (code != PWDC_CODER_RANGE && code != PWDC_CODER_HUFF) return -1;
+  *coder = (pwdc_coder)code;
+  return pwdc_container_entry(c, (uint64_t)c->num_tables + i, data, nbytes);
+}
+
+int pwdc_container_table(const pwdc_container *c, uint32_t i,
+                         const unsigned char **data, uint32_t *nbytes) {
+  if (i >= c->num_tables) return -1;
+  return pwdc_container_entry(c, i, data, nbytes);
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef AOM_AOM_DSP_PWDC_CONTAINER_H_
+#define AOM_AOM_DSP_PWDC_CONTAINER_H_
+
+#include <stddef.h>
+
+#include "aom_dsp/pwdc_select.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*PWDC substream container.
+  Packs the substreams of a frame (one per tile, each the output of
+   od_ec_enc_done() or pwdc_huff_enc_done()) with the coder each one uses
+   and any shared per-channel table descriptors, so a decoder can hand every
+   substream to its own thread.
+  Layout:
+   1 byte: version << 4 | (offset width - 1); bits 2-3 reserved and zero
+   leb128: number of tables T
+   leb128: number of substreams S
+   (T + S) offsets, each the end of an entry in the data area, little-endian
+    in the offset width (1 to 4 bytes, the fewest that fit the data area)
+   ceil(S / 4) bytes: the coder of each substream, 2 bits each, LSB first
+   the data area: the tables, then the substreams, back to back
+  Entry k spans from the end of entry k - 1 (0 for the first) to its own
+   end, so any table or substream is found in O(1) from two offsets. The
+   coder map replaces the one-byte pwdc_select header of each substream.
+  The parser checks every offset it reads against the data area, so
+   arbitrary input is safe.*/
+
+#define PWDC_CONTAINER_VERSION (1)
+
+typedef struct {
+  const unsigned char *data;
+  uint32_t nbytes;
+} pwdc_container_blob;
+
+/*The size pwdc_container_write() needs, or -1 if the data area would
+   exceed 4 GiB.*/
+OD_WARN_UNUSED_RESULT int64_t pwdc_container_size(
+    const pwdc_container_blob *tables, uint32_t num_tables,
+    const pwdc_container_blob *substreams, uint32_t num_substreams);
+
+/*Writes a container to dst. coders holds one pwdc_coder per substream.
+  Returns the number of bytes written, or -1 if dst_size is too small or a
+   coder is invalid.*/
+int64_t pwdc_container_write(unsigned char *dst, size_t dst_size,
+                             const pwdc_container_blob *tables,
+                             uint32_t num_tables,
+                             const pwdc_container_blob *substreams,
+                             const pwdc_coder *coders,
+                             uint32_t num_substreams) OD_ARG_NONNULL(1);
+
+/*A parsed container. Points into the caller's buffer.*/
+typedef struct {
+  const unsigned char *offsets;
+  const unsigned char *coders;
+  const unsigned char *data;
+  size_t data_size;
+  uint32_t num_tables;
+  uint32_t num_substreams;
+  int width;
+} pwdc_container;
+
+/*Parses the header of the container in buf. Takes time independent of the
+   number of entries. Returns 0 on success.*/
+int pwdc_container_open(pwdc_container *c, const unsigned char *buf,
+                        size_t size) OD_ARG_NONNULL(1);
+
+/*Locates substream i. Returns 0 on success, or -1 if i is out of range or
+   its offsets or coder are invalid.*/
+int pwdc_container_substream(const pwdc_container *c, uint32_t i,
+                             const unsigned char **data, uint32_t *nbytes,
+                             pwdc_coder *coder) OD_ARG_NONNULL(1)
+    OD_ARG_NONNULL(3) OD_ARG_NONNULL(4) OD_ARG_NONNULL(5);
+
+/*Locates table descriptor i. Returns 0 on success.*/
+int pwdc_container_table(const pwdc_container *c, uint32_t i,
+                         const unsigned char **data, uint32_t *nbytes)
+    OD_ARG_NONNULL(1) OD_ARG_NONNULL(3) OD_ARG_NONNULL(4);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_AOM_DSP_PWDC_CONTAINER_H_
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+/*pwdc_container_fuzzer: libFuzzer target for the container parser (see
+   pwdc_container.h).
+  Each input is parsed as a container, and every table and substream it
+   claims is looked up and read. The same bytes are also cut into tables and
+   substreams, written as a container and parsed back, which must give the
+   same entries.
+  Built with -DPWDC_FUZZER_STANDALONE, the target gets a main() that runs
+   each file named on the command line, e.g. to replay a corpus without
+   libFuzzer.*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aom_dsp/pwdc_container.h"
+
+/*The most entries the round trip cuts from one input.*/
+#define PWDC_FUZZER_MAX_ENTRIES (256)
+
+static void pwdc_fuzzer_check_range(const unsigned char *data, uint32_t nbytes,
+                                    const uint8_t *buf, size_t size) {
+  if (data < buf || nbytes > size || data - buf > (ptrdiff_t)(size - nbytes)) {
+    abort();
+  }
+  /*Touch both ends, so ASan sees any read past the input.*/
+  if (nbytes > 0) {
+    volatile unsigned char x = data[0];
+    x = data[nbytes - 1];
+    (void)x;
+  }
+}
+
+/*Parses buf as a container and reads every entry it lists.*/
+static void pwdc_fuzzer_parse(const uint8_t *buf, size_t size) {
+  pwdc_container c;
+  const unsigned char *data;
+  uint32_t nbytes;
+  pwdc_coder coder;
+  if (pwdc_container_open(&c, buf, size)) return;
+  for (uint32_t i = 0; i < c.num_tables; i++) {
+    if (!pwdc_container_table(&c, i, &data, &nbytes)) {
+      pwdc_fuzzer_check_range(data, nbytes, buf, size);
+    }
+  }
+  for (uint32_t i = 0; i < c.num_substreams; i++) {
+    if (!pwdc_container_substream(&c, i, &data, &nbytes, &coder)) {
+      pwdc_fuzzer_check_range(data, nbytes, buf, size);
+      if (coder != PWDC_CODER_RANGE && coder != PWDC_CODER_HUFF) abort();
+    }
+  }
+  if (!pwdc_container_table(&c, c.num_tables, &data, &nbytes)) abort();
+  if (!pwdc_container_substream(&c, c.num_substreams, &data, &nbytes,
+                                &coder)) {
+    abort();
+  }
+}
+
+/*Cuts buf into entries, each a length byte followed by up to that many
+   bytes, with the first byte choosing how many are tables. Writes them as a
+   container and checks that parsing it gives them back.*/
+static void pwdc_fuzzer_round_trip(const uint8_t *buf, size_t size) {
+  pwdc_container_blob blobs[PWDC_FUZZER_MAX_ENTRIES];
+  pwdc_coder coders[PWDC_FUZZER_MAX_ENTRIES];
+  uint32_t num_entries = 0;
+  if (size < 1) return;
+  size_t pos = 1;
+  while (pos < size && num_entries < PWDC_FUZZER_MAX_ENTRIES) {
+    const uint32_t len = buf[pos++];
+    const uint32_t nbytes = len < size - pos ? len : (uint32_t)(size - pos);
+    coders[num_entries] = (pwdc_coder)(len & 1);
+    blobs[num_entries].data = buf + pos;
+    blobs[num_entries].nbytes = nbytes;
+    num_entries++;
+    pos += nbytes;
+  }
+  const uint32_t num_tables = buf[0] % (num_entries + 1);
+  const uint32_t num_substreams = num_entries - num_tables;
+  const pwdc_container_blob *substreams = blobs + num_tables;
+  const pwdc_coder *substream_coders = coders + num_tables;
+  const int64_t total =
+      pwdc_container_size(blobs, num_tables, substreams, num_substreams);
+  if (total <= 0) abort();
+  /*Exactly the size, so ASan catches the writer or parser overrunning it.*/
+  unsigned char *out = (unsigned char *)malloc((size_t)total);
+  if (out == NULL) return;
+  if (pwdc_container_write(out, (size_t)total - 1, blobs, num_tables,
+                           substreams, substream_coders,
+                           num_substreams) != -1) {
+    abort();
+  }
+  if (pwdc_container_write(out, (size_t)total, blobs, num_tables, substreams,
+                           substream_coders, num_substreams) != total) {
+    abort();
+  }
+  pwdc_container c;
+  const unsigned char *data;
+  uint32_t nbytes;
+  pwdc_coder coder;
+  if (pwdc_container_open(&c, out, (size_t)total)) abort();
+  if (c.num_tables != num_tables || c.num_substreams != num_substreams) {
+    abort();
+  }
+  for (uint32_t i = 0; i < num_tables; i++) {
+    if (pwdc_container_table(&c, i, &data, &nbytes) ||
+        nbytes != blobs[i].nbytes ||
+        (nbytes > 0 && memcmp(data, blobs[i].data, nbytes))) {
+      abort();
+    }
+  }
+  for (uint32_t i = 0; i < num_substreams; i++) {
+    if (pwdc_container_substream(&c, i, &data, &nbytes, &coder) ||
+        nbytes != substreams[i].nbytes || coder != substream_coders[i] ||
+        (nbytes > 0 && memcmp(data, substreams[i].data, nbytes))) {
+      abort();
+    }
+  }
+  free(out);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  /*A heap copy of exactly the input's size, so reads past it are caught.*/
+  uint8_t *buf = (uint8_t *)malloc(size > 0 ? size : 1);
+  if (buf == NULL) return 0;
+  if (size > 0) memcpy(buf, data, size);
+  pwdc_fuzzer_parse(buf, size);
+  pwdc_fuzzer_round_trip(buf, size);
+  free(buf);
+  return 0;
+}
+
+#if defined(PWDC_FUZZER_STANDALONE)
+int main(int argc, char **argv) {
+  for (int a = 1; a < argc; a++) {
+    FILE *f = fopen(argv[a], "rb");
+    if (f == NULL) {
+      fprintf(stderr, "%s: cannot open\n", argv[a]);
+      return EXIT_FAILURE;
+    }
+    uint8_t *buf = NULL;
+    size_t size = 0;
+    size_t alloc = 0;
+    for (;;) {
+      if (size == alloc) {
+        alloc = alloc ? 2 * alloc : 4096;
+        uint8_t *grown = (uint8_t *)realloc(buf, alloc);
+        if (grown == NULL) {
+          free(buf);
+          fclose(f);
+          return EXIT_FAILURE;
+        }
+        buf = grown;
+      }
+      const size_t got = fread(buf + size, 1, alloc - size, f);
+      if (got == 0) break;
+      size += got;
+    }
+    fclose(f);
+    LLVMFuzzerTestOneInput(buf, size);
+    free(buf);
+  }
+  return EXIT_SUCCESS;
+}
+#endif  // PWDC_FUZZER_STANDALONE
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+/*pwdc_dec_test: encode->decode round trips and decode throughput of the
+   range decoder (see entdec.c), in whichever configuration it is built with.
+  Usage: pwdc_dec_test [num_symbols]
+  Writes num_symbols symbols (default 2000000) over 16-, 8- and 4-ary
+   contexts, with bools of varying probability mixed in. The symbols are
+   either skewed towards 0, as most AV1 symbols are, or spread evenly over
+   the alphabet, and each set is coded once with fixed CDFs and once adapting
+   them with update_cdf(). Each stream is decoded several times and checked,
+   and the best decode rate is printed.
+  The window and the symbol search are chosen when entdec.c is compiled, so
+   this must be built with the same OD_EC_DEC_WIDE_WINDOW and OD_EC_DEC_SIMD
+   as entdec.c (see README.md), once per configuration to compare.*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aom_dsp/bitwriter.h"
+#include "aom_dsp/entdec.h"
+#include "aom_ports/aom_timer.h"
+
+#define PWDC_DEC_TEST_CONTEXTS (48)
+#define PWDC_DEC_TEST_RUNS (5)
+
+/*The symbol search entdec.c selects, by the same rules.*/
+#if defined(OD_EC_DEC_SIMD) && OD_EC_DEC_SIMD && defined(__AVX2__)
+#define PWDC_DEC_TEST_SEARCH "AVX2"
+#elif defined(OD_EC_DEC_SIMD) && OD_EC_DEC_SIMD && \
+    (defined(__SSE2__) || defined(_M_X64) ||        \
+     (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define PWDC_DEC_TEST_SEARCH "SSE2"
+#elif defined(OD_EC_DEC_SIMD) && OD_EC_DEC_SIMD && defined(__ARM_NEON) && \
+    defined(__aarch64__)
+#define PWDC_DEC_TEST_SEARCH "NEON"
+#else
+#define PWDC_DEC_TEST_SEARCH "scalar"
+#endif
+
+typedef struct {
+  uint8_t ctx;
+  uint8_t s;
+  /*The probability of a zero, in Q15, of a bool coded before the symbol, or 0
+     if there is none.*/
+  uint16_t bool_f;
+  uint8_t bit;
+} pwdc_dec_test_sym;
+
+static uint32_t pwdc_dec_test_rand(uint32_t *seed) {
+  *seed = *seed * 1103515245 + 12345;
+  return *seed >> 8;
+}
+
+static int pwdc_dec_test_nsyms(int c) { return 16 >> (c % 3); }
+
+static void pwdc_dec_test_init_cdfs(aom_cdf_prob (*cdfs)[CDF_SIZE(16)]) {
+  memset(cdfs, 0, PWDC_DEC_TEST_CONTEXTS * sizeof(*cdfs));
+  for (int c = 0; c < PWDC_DEC_TEST_CONTEXTS; c++) {
+    const int n = pwdc_dec_test_nsyms(c);
+    for (int i = 0; i < n - 1; i++) {
+      cdfs[c][i] = AOM_ICDF((i + 1) * CDF_PROB_TOP / n);
+    }
+  }
+}
+
+static double pwdc_dec_test_rate(uint32_t n, struct aom_usec_timer *timer) {
+  const int64_t usec = aom_usec_timer_elapsed(timer);
+  return usec > 0 ? n / (double)usec : 0;
+}
+
+/*Fills syms with n symbols, skewed or flat, and bools.*/
+static void pwdc_dec_test_make(pwdc_dec_test_sym *syms, uint32_t n, int flat) {
+  uint32_t seed = 17;
+  for (uint32_t i = 0; i < n; i++) {
+    const int c = (int)(pwdc_dec_test_rand(&seed) % PWDC_DEC_TEST_CONTEXTS);
+    const int nsyms = pwdc_dec_test_nsyms(c);
+    int s = 0;
+    if (flat) {
+      s = (int)(pwdc_dec_test_rand(&seed) % nsyms);
+    } else {
+      while (s < nsyms - 1 && pwdc_dec_test_rand(&seed) % (2 + c % 5) == 0) {
+        s++;
+      }
+    }
+    syms[i].ctx = (uint8_t)c;
+    syms[i].s = (uint8_t)s;
+    syms[i].bool_f = 0;
+    syms[i].bit = 0;
+    /*About one bool for every three symbols.*/
+    if (pwdc_dec_test_rand(&seed) % 3 == 0) {
+      const uint32_t f = 1 + pwdc_dec_test_rand(&seed) % 32767;
+      syms[i].bool_f = (uint16_t)f;
+      syms[i].bit = pwdc_dec_test_rand(&seed) % 32768 >= f;
+    }
+  }
+}
+
+/*Codes syms with fixed or adapted CDFs, then decodes the stream
+   PWDC_DEC_TEST_RUNS times, and prints the best decode rate.*/
+static int pwdc_dec_test_round_trip(const pwdc_dec_test_sym *syms, uint32_t n,
+                                    const char *set, int adapt) {
+  aom_cdf_prob(*cdfs)[CDF_SIZE(16)] = (aom_cdf_prob(*)[CDF_SIZE(16)])malloc(
+      PWDC_DEC_TEST_CONTEXTS * sizeof(*cdfs));
+  char name[32];
+  aom_writer w;
+  od_ec_dec dec;
+  struct aom_usec_timer timer;
+  uint32_t num_records = 0;
+  uint32_t nbytes;
+  double rate = 0;
+  int ret = -1;
+  snprintf(name, sizeof(name), "%s, %s CDFs", set,
+           adapt ? "adaptive" : "fixed");
+  memset(&w, 0, sizeof(w));
+  od_ec_enc_init(&w.ec, 1024);
+  w.allow_update_cdf = adapt;
+  if (cdfs == NULL) goto done;
+
+  pwdc_dec_test_init_cdfs(cdfs);
+  for (uint32_t i = 0; i < n; i++) {
+    const pwdc_dec_test_sym *sym = &syms[i];
+    if (sym->bool_f) {
+      od_ec_encode_bool_q15(&w.ec, sym->bit, sym->bool_f);
+      num_records++;
+    }
+    aom_write_symbol(&w, sym->s, cdfs[sym->ctx],
+                     pwdc_dec_test_nsyms(sym->ctx));
+    num_records++;
+  }
+  const unsigned char *buf = od_ec_enc_done(&w.ec, &nbytes);
+  if (buf == NULL) {
+    fprintf(stderr, "%s: coding failed\n", name);
+    goto done;
+  }
+
+  for (int run = 0; run < PWDC_DEC_TEST_RUNS; run++) {
+    pwdc_dec_test_init_cdfs(cdfs);
+    aom_usec_timer_start(&timer);
+    od_ec_dec_init(&dec, buf, nbytes);
+    for (uint32_t i = 0; i < n; i++) {
+      const pwdc_dec_test_sym *sym = &syms[i];
+      const int nsyms = pwdc_dec_test_nsyms(sym->ctx);
+      if (sym->bool_f &&
+          od_ec_decode_bool_q15(&dec, sym->bool_f) != sym->bit) {
+        fprintf(stderr, "%s: bool %u mismatch\n", name, i);
+        goto done;
+      }
+      const int s = od_ec_decode_cdf_q15(&dec, cdfs[sym->ctx], nsyms);
+      if (s != sym->s) {
+        fprintf(stderr, "%s: symbol %u mismatch\n", name, i);
+        goto done;
+      }
+      if (adapt) update_cdf(cdfs[sym->ctx], (int8_t)s, nsyms);
+    }
+    aom_usec_timer_mark(&timer);
+    if (od_ec_dec_tell(&dec) > (int)nbytes * 8) {
+      fprintf(stderr, "%s: decoder read %d bits of %u bytes\n", name,
+              od_ec_dec_tell(&dec), nbytes);
+      goto done;
+    }
+    const double run_rate = pwdc_dec_test_rate(num_records, &timer);
+    if (run_rate > rate) rate = run_rate;
+  }
+  printf("%s: %u records in %u bytes, decode %.1f Msym/s\n", name,
+         num_records, nbytes, rate);
+  ret = 0;
+done:
+  od_ec_enc_clear(&w.ec);
+  free(cdfs);
+  return ret;
+}
+
+int main(int argc, char **argv) {
+  const long n = argc > 1 ? strtol(argv[1], NULL, 0) : 2000000;
+  pwdc_dec_test_sym *syms;
+  int ret = EXIT_FAILURE;
+  if (n < 1 || n > (1 << 28)) {
+    fprintf(stderr, "Usage: %s [num_symbols]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  syms = (pwdc_dec_test_sym *)malloc(n * sizeof(*syms));
+  if (syms == NULL) return EXIT_FAILURE;
+  printf("window %d bits, %s symbol search\n", OD_EC_DEC_WINDOW_SIZE,
+         PWDC_DEC_TEST_SEARCH);
+  for (int flat = 0; flat <= 1; flat++) {
+    const char *set = flat ? "flat" : "skewed";
+    pwdc_dec_test_make(syms, (uint32_t)n, flat);
+    if (pwdc_dec_test_round_trip(syms, (uint32_t)n, set, 0) ||
+        pwdc_dec_test_round_trip(syms, (uint32_t)n, set, 1)) {
+      goto done;
+    }
+  }
+  printf("pwdc_dec_test: OK\n");
+  ret = EXIT_SUCCESS;
+done:
+  free(syms);
+  return ret;
+}
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+/*pwdc_enc_test: encode throughput of the range encoder (see entenc.c), in
+   whichever configuration it is built with.
+  Usage: pwdc_enc_test [num_symbols [num_threads]]
+  Codes num_symbols symbols (default 2000000) over 16-, 8- and 4-ary
+   contexts with fixed CDFs, as three traces: symbols skewed towards 0, as
+   most AV1 symbols are, with some bools mixed in; symbols spread evenly over
+   the alphabet; and bools alone, mostly near-certain, as skip and
+   partition flags are. Each trace is coded PWDC_ENC_TEST_RUNS times into a
+   recycled encoder and must give the same bytes every time. The best time
+   per symbol is printed, with the flushes of the coder's window and a hash
+   of the output, which must not change between configurations.
+  Then the skewed trace is cut into tiles and coded on num_threads workers
+   (default 4) with an od_ec_tile_pool, and the best rate is printed.
+  Rates vary by a few percent from run to run, so compare two encoders over
+   several alternating runs of each.*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aom_dsp/entenc_mt.h"
+#include "aom_ports/aom_timer.h"
+
+#define PWDC_ENC_TEST_CONTEXTS (48)
+#define PWDC_ENC_TEST_RUNS (7)
+#define PWDC_ENC_TEST_TILES (64)
+
+typedef struct {
+  uint8_t ctx;
+  uint8_t s;
+  /*The probability of a one, in Q15, of a bool coded before the symbol, or 0
+     if there is none.*/
+  uint16_t bool_f;
+  uint8_t bit;
+  /*Nonzero to code only the bool.*/
+  uint8_t bool_only;
+} pwdc_enc_test_sym;
+
+typedef struct {
+  const pwdc_enc_test_sym *syms;
+  uint32_t n;
+  const aom_cdf_prob (*cdfs)[CDF_SIZE(16)];
+} pwdc_enc_test_trace;
+
+static uint32_t pwdc_enc_test_rand(uint32_t *seed) {
+  *seed = *seed * 1103515245 + 12345;
+  return *seed >> 8;
+}
+
+static int pwdc_enc_test_nsyms(int c) { return 16 >> (c % 3); }
+
+/*Fills syms with n symbols of trace 0 (skewed), 1 (flat) or 2 (bools).*/
+static void pwdc_enc_test_make(pwdc_enc_test_sym *syms, uint32_t n,
+                               int trace) {
+  uint32_t seed = 17;
+  for (uint32_t i = 0; i < n; i++) {
+    const int c = (int)(pwdc_enc_test_rand(&seed) % PWDC_ENC_TEST_CONTEXTS);
+    const int nsyms = pwdc_enc_test_nsyms(c);
+    int s = 0;
+    if (trace == 1) {
+      s = (int)(pwdc_enc_test_rand(&seed) % nsyms);
+    } else {
+      while (s < nsyms - 1 && pwdc_enc_test_rand(&seed) % (2 + c % 5) == 0) {
+        s++;
+      }
+    }
+    memset(&syms[i], 0, sizeof(syms[i]));
+    syms[i].ctx = (uint8_t)c;
+    syms[i].s = (uint8_t)s;
+    if (trace == 2) {
+      /*Three bools in four are near-certain.*/
+      uint32_t f = 1 + pwdc_enc_test_rand(&seed) % 32767;
+      if (pwdc_enc_test_rand(&seed) % 4 != 0) f = 32000 + f % 760;
+      syms[i].bool_f = (uint16_t)f;
+      syms[i].bit = pwdc_enc_test_rand(&seed) % 32768 < f;
+      syms[i].bool_only = 1;
+    } else if (trace == 0 && pwdc_enc_test_rand(&seed) % 3 == 0) {
+      const uint32_t f = 1 + pwdc_enc_test_rand(&seed) % 32767;
+      syms[i].bool_f = (uint16_t)f;
+      syms[i].bit = pwdc_enc_test_rand(&seed) % 32768 < f;
+    }
+  }
+}
+
+static void pwdc_enc_test_code(od_ec_enc *enc, const pwdc_enc_test_trace *t,
+                               uint32_t from, uint32_t to) {
+  for (uint32_t i = from; i < to; i++) {
+    const pwdc_enc_test_sym *sym = &t->syms[i];
+    if (sym->bool_f) od_ec_encode_bool_q15(enc, sym->bit, sym->bool_f);
+    if (!sym->bool_only) {
+      od_ec_encode_cdf_q15(enc, sym->s, t->cdfs[sym->ctx],
+                           pwdc_enc_test_nsyms(sym->ctx));
+    }
+  }
+}
+
+/*FNV-1a.*/
+static uint32_t pwdc_enc_test_hash(const unsigned char *buf, uint32_t n) {
+  uint32_t h = 2166136261u;
+  for (uint32_t i = 0; i < n; i++) h = (h ^ buf[i]) * 16777619u;
+  return h;
+}
+
+static int pwdc_enc_test_trace_run(const pwdc_enc_test_trace *t,
+                                   const char *name) {
+  od_ec_enc enc;
+  struct aom_usec_timer timer;
+  pwdc_stats stats;
+  int64_t best = -1;
+  uint32_t hash = 0;
+  uint32_t nbytes = 0;
+  int ret = -1;
+  od_ec_enc_init(&enc, 1024);
+  for (int run = 0; run < PWDC_ENC_TEST_RUNS; run++) {
+    pwdc_stats_reset();
+    aom_usec_timer_start(&timer);
+    pwdc_enc_test_code(&enc, t, 0, t->n);
+    const unsigned char *out = od_ec_enc_done(&enc, &nbytes);
+    aom_usec_timer_mark(&timer);
+    if (out == NULL) {
+      fprintf(stderr, "%s: coding failed\n", name);
+      goto done;
+    }
+    const uint32_t run_hash = pwdc_enc_test_hash(out, nbytes);
+    if (run > 0 && run_hash != hash) {
+      fprintf(stderr, "%s: run %d gave different bytes\n", name, run);
+      goto done;
+    }
+    hash = run_hash;
+    const int64_t usec = aom_usec_timer_elapsed(&timer);
+    if (best < 0 || usec < best) best = usec;
+    od_ec_enc_recycle(&enc);
+  }
+  pwdc_stats_get(&stats);
+  printf("%s: %u symbols in %u bytes (hash %08x), %llu flushes, "
+         "%.2f ns/symbol\n",
+         name, t->n, nbytes, hash, (unsigned long long)stats.flush_count,
+         1000.0 * best / t->n);
+  ret = 0;
+done:
+  od_ec_enc_clear(&enc);
+  return ret;
+}
+
+static int pwdc_enc_test_tile(void *priv, int tile_idx, aom_writer *w) {
+  const pwdc_enc_test_trace *t = (const pwdc_enc_test_trace *)priv;
+  const uint32_t from = (uint32_t)((uint64_t)t->n * tile_idx /
+                                   PWDC_ENC_TEST_TILES);
+  const uint32_t to = (uint32_t)((uint64_t)t->n * (tile_idx + 1) /
+                                 PWDC_ENC_TEST_TILES);
+  pwdc_enc_test_code(&w->ec, t, from, to);
+  return 0;
+}
+
+static int pwdc_enc_test_tiles(const pwdc_enc_test_trace *t,
+                               int num_threads) {
+  od_ec_tile_pool *pool = od_ec_tile_pool_create(num_threads);
+  struct aom_usec_timer timer;
+  int64_t best = -1;
+  if (pool == NULL) return -1;
+  for (int run = 0; run < PWDC_ENC_TEST_RUNS; run++) {
+    aom_usec_timer_start(&timer);
+    if (od_ec_tile_pool_encode(pool, PWDC_ENC_TEST_TILES, NULL,
+                               pwdc_enc_test_tile, (void *)t)) {
+      fprintf(stderr, "tiles: coding failed\n");
+      od_ec_tile_pool_destroy(pool);
+      return -1;
+    }
+    aom_usec_timer_mark(&timer);
+    const int64_t usec = aom_usec_timer_elapsed(&timer);
+    if (best < 0 || usec < best) best = usec;
+  }
+  od_ec_tile_pool_destroy(pool);
+  printf("skewed, %d tiles on %d threads: %.1f Msym/s\n", PWDC_ENC_TEST_TILES,
+         num_threads, best > 0 ? t->n / (double)best : 0);
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  static const char *const names[3] = { "skewed", "flat", "bools" };
+  const long n = argc > 1 ? strtol(argv[1], NULL, 0) : 2000000;
+  const int num_threads = argc > 2 ? atoi(argv[2]) : 4;
+  aom_cdf_prob(*cdfs)[CDF_SIZE(16)];
+  pwdc_enc_test_trace t;
+  pwdc_enc_test_sym *syms;
+  int ret = EXIT_FAILURE;
+  if (n < PWDC_ENC_TEST_TILES || n > (1 << 28) || num_threads < 1) {
+    fprintf(stderr, "Usage: %s [num_symbols [num_threads]]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  syms = (pwdc_enc_test_sym *)malloc(n * sizeof(*syms));
+  cdfs = (aom_cdf_prob(*)[CDF_SIZE(16)])calloc(PWDC_ENC_TEST_CONTEXTS,
+                                               sizeof(*cdfs));
+  if (syms == NULL || cdfs == NULL) goto done;
+  for (int c = 0; c < PWDC_ENC_TEST_CONTEXTS; c++) {
+    const int nsyms = pwdc_enc_test_nsyms(c);
+    for (int i = 0; i < nsyms - 1; i++) {
+      cdfs[c][i] = AOM_ICDF((i + 1) * CDF_PROB_TOP / nsyms);
+    }
+  }
+  t.syms = syms;
+  t.n = (uint32_t)n;
+  t.cdfs = (const aom_cdf_prob(*)[CDF_SIZE(16)])cdfs;
+  for (int trace = 2; trace >= 0; trace--) {
+    pwdc_enc_test_make(syms, (uint32_t)n, trace);
+    if (pwdc_enc_test_trace_run(&t, names[trace])) goto done;
+  }
+  /*syms now holds the skewed trace.*/
+  if (pwdc_enc_test_tiles(&t, num_threads)) goto done;
+  printf("pwdc_enc_test: OK\n");
+  ret = EXIT_SUCCESS;
+done:
+  free(syms);
+  free(cdfs);
+  return ret;
+}
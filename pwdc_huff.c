@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aom_dsp/pwdc_huff.h"
+
+typedef struct {
+  uint32_t count[16];
+  int nsyms;
+  uint8_t lens[16];
+  uint16_t codes[16];
+} pwdc_huff_hist;
+
+void pwdc_huff_build_lengths(const uint32_t *hist, int n, int max_len,
+                             uint8_t *lens) {
+  /*Leaves come first, then the internal nodes in order of creation.*/
+  uint64_t weight[2 * 16];
+  int parent[2 * 16];
+  int leaf[16];
+  int m = 0;
+  assert(n <= 16);
+  memset(lens, 0, n * sizeof(*lens));
+  for (int i = 0; i < n; i++) {
+    if (hist[i] > 0) {
+      weight[m] = hist[i];
+      leaf[m++] = i;
+    }
+  }
+  if (m == 0) return;
+  if (m == 1) {
+    lens[leaf[0]] = 1;
+    return;
+  }
+  /*The alphabets are at most 16 symbols, so a quadratic search for the two
+     lightest live nodes is cheaper than maintaining a heap.*/
+  int nodes = m;
+  for (int i = 0; i < 2 * m - 1; i++) parent[i] = -1;
+  for (int k = 0; k < m - 1; k++) {
+    int a = -1;
+    int b = -1;
+    for (int i = 0; i < nodes; i++) {
+      if (parent[i] != -1) continue;
+      if (a < 0 || weight[i] < weight[a]) {
+        b = a;
+        a = i;
+      } else if (b < 0 || weight[i] < weight[b]) {
+        b = i;
+      }
+    }
+    weight[nodes] = weight[a] + weight[b];
+    parent[a] = parent[b] = nodes++;
+  }
+  int kraft = 0;
+  for (int i = 0; i < m; i++) {
+    int len = 0;
+    for (int p = i; parent[p] != -1; p = parent[p]) len++;
+    len = OD_MINI(len, max_len);
+    lens[leaf[i]] = (uint8_t)len;
+    kraft += 1 << (max_len - len);
+  }
+  /*Clamping to max_len oversubscribes the code; lengthen the longest codes
+     that are still short enough until it fits again.*/
+  while (kraft > 1 << max_len) {
+    int j = -1;
+    for (int i = 0; i < n; i++) {
+      if (lens[i] > 0 && lens[i] < max_len &&
+          (j < 0 || lens[i] > lens[j] ||
+           (lens[i] == lens[j] && hist[i] < hist[j]))) {
+        j = i;
+      }
+    }
+    kraft -= 1 << (max_len - lens[j] - 1);
+    lens[j]++;
+  }
+}
+
+void pwdc_huff_build_codes(const uint8_t *lens, int n, uint16_t *codes) {
+  int count[PWDC_HUFF_MAX_LEN + 2] = { 0 };
+  int next[PWDC_HUFF_MAX_LEN + 2];
+  for (int i = 0; i < n; i++) count[lens[i]]++;
+  count[0] = 0;
+  next[1] = 0;
+  for (int len = 1; len <= PWDC_HUFF_MAX_LEN; len++) {
+    next[len + 1] = (next[len] + count[len]) << 1;
+  }
+  for (int i = 0; i < n; i++) {
+    codes[i] = lens[i] ? (uint16_t)next[lens[i]]++ : 0;
+  }
+}
+
+void pwdc_huff_enc_init(pwdc_huff_enc *enc, uint32_t size) {
+  enc->buf = (unsigned char *)malloc(size);
+  enc->storage = enc->buf == NULL ? 0 : size;
+  enc->offs = 0;
+  enc->acc = 0;
+  enc->nbits = 0;
+  enc->error = enc->buf == NULL ? -1 : 0;
+}
+
+void pwdc_huff_enc_clear(pwdc_huff_enc *enc) {
+  free(enc->buf);
+  enc->buf = NULL;
+  enc->storage = 0;
+}
+
+static int pwdc_huff_grow(pwdc_huff_enc *enc) {
+  const uint32_t storage = 2 * enc->storage + 1024;
+  unsigned char *buf = (unsigned char *)realloc(enc->buf, storage);
+  if (buf == NULL) {
+    enc->error = -1;
+    enc->offs = 0;
+    return -1;
+  }
+  enc->buf = buf;
+  enc->storage = storage;
+  return 0;
+}
+
+/*Appends the len low bits of code. Whole 32-bit words leave the bit buffer
+   as soon as they are complete, so nbits stays below 32 between calls.*/
+static inline void pwdc_huff_put(pwdc_huff_enc *enc, unsigned code,
+                                 int len) {
+  enc->acc = enc->acc << len | code;
+  enc->nbits += len;
+  if (enc->nbits >= 32) {
+    if (enc->offs + 4 > enc->storage && pwdc_huff_grow(enc)) return;
+    enc->nbits -= 32;
+    const uint32_t word = (uint32_t)(enc->acc >> enc->nbits);
+    unsigned char *out = enc->buf + enc->offs;
+    out[0] = (unsigned char)(word >> 24);
+    out[1] = (unsigned char)(word >> 16);
+    out[2] = (unsigned char)(word >> 8);
+    out[3] = (unsigned char)word;
+    enc->offs += 4;
+  }
+}
+
+int pwdc_huff_begin(od_ec_symbuf *sb, od_ec_enc *ec) {
+  if (od_ec_symbuf_track_contexts(sb)) return -1;
+  od_ec_symbuf_reset(sb);
+  ec->symbuf = sb;
+  return 0;
+}
+
+/*Builds the histogram and code of every group. The bools are counted in
+   hist[0].count[0]. Returns NULL on failure.*/
+static pwdc_huff_hist *pwdc_huff_analyze(const od_ec_symbuf *sb) {
+  const uint32_t num_ctx = sb->num_ctx;
+  if (sb->error) return NULL;
+  pwdc_huff_hist *hist = (pwdc_huff_hist *)calloc(num_ctx + 1, sizeof(*hist));
+  if (hist == NULL) return NULL;
+  const od_ec_symbuf_block *blk = sb->head;
+  for (uint32_t b = 0; blk != NULL && b <= sb->nblocks; b++) {
+    const uint32_t n = b < sb->nblocks ? OD_EC_SYMBUF_BLOCK_SIZE
+                                       : (uint32_t)(sb->pos - blk->syms);
+    for (uint32_t i = 0; i < n; i++) {
+      const od_ec_sym *sym = &blk->syms[i];
+      if (sym->nsyms == 0) {
+        hist[0].count[0]++;
+        continue;
+      }
+      /*A symbol without a context number has no group to be coded in.*/
+      if (sym->ctx == 0) {
+        free(hist);
+        return NULL;
+      }
+      assert(sym->nsyms <= 16);
+      hist[sym->ctx].count[sym->s]++;
+      hist[sym->ctx].nsyms = sym->nsyms;
+    }
+    blk = blk->next;
+  }
+  for (uint32_t c = 1; c <= num_ctx; c++) {
+    pwdc_huff_hist *h = &hist[c];
+    h->nsyms = OD_MAXI(h->nsyms, 1);
+    pwdc_huff_build_lengths(h->count, h->nsyms, PWDC_HUFF_MAX_LEN, h->lens);
+    pwdc_huff_build_codes(h->lens, h->nsyms, h->codes);
+  }
+  return hist;
+}
+
+int64_t pwdc_huff_cost(const od_ec_symbuf *sb) {
+  pwdc_huff_hist *hist = pwdc_huff_analyze(sb);
+  if (hist == NULL) return -1;
+  int64_t bits = 16 + hist[0].count[0];
+  for (uint32_t c = 1; c <= sb->num_ctx; c++) {
+    const pwdc_huff_hist *h = &hist[c];
+    bits += 4 + 4 * h->nsyms;
+    for (int i = 0; i < h->nsyms; i++) {
+      bits += (int64_t)h->count[i] * h->lens[i];
+    }
+  }
+  free(hist);
+  return bits;
+}
+
+int pwdc_huff_encode(pwdc_huff_enc *enc, od_ec_symbuf *sb, od_ec_enc *ec) {
+  int ret = 0;
+  ec->symbuf = NULL;
+  pwdc_huff_hist *hist = pwdc_huff_analyze(sb);
+  if (hist == NULL) return -1;
+  pwdc_huff_put(enc, sb->num_ctx, 16);
+  for (uint32_t c = 1; c <= sb->num_ctx; c++) {
+    const pwdc_huff_hist *h = &hist[c];
+    pwdc_huff_put(enc, h->nsyms - 1, 4);
+    for (int i = 0; i < h->nsyms; i++) pwdc_huff_put(enc, h->lens[i], 4);
+  }
+
+  const od_ec_symbuf_block *blk = sb->head;
+  for (uint32_t b = 0; blk != NULL && b <= sb->nblocks; b++) {
+    const uint32_t n = b < sb->nblocks ? OD_EC_SYMBUF_BLOCK_SIZE
+                                       : (uint32_t)(sb->pos - blk->syms);
+    for (uint32_t i = 0; i < n; i++) {
+      const od_ec_sym *sym = &blk->syms[i];
+      if (sym->nsyms == 0) {
+        pwdc_huff_put(enc, sym->s, 1);
+      } else {
+        const pwdc_huff_hist *h = &hist[sym->ctx];
+        pwdc_huff_put(enc, h->codes[sym->s], h->lens[sym->s]);
+      }
+    }
+    blk = blk->next;
+  }
+  if (enc->error) ret = -1;
+  free(hist);
+  return ret;
+}
+
+unsigned char *pwdc_huff_enc_done(pwdc_huff_enc *enc, uint32_t *nbytes) {
+  /*Pad the last byte with zeros.*/
+  const int pad = -enc->nbits & 7;
+  enc->acc <<= pad;
+  enc->nbits += pad;
+  while (enc->nbits > 0) {
+    if (enc->offs >= enc->storage && pwdc_huff_grow(enc)) break;
+    enc->nbits -= 8;
+    enc->buf[enc->offs++] = (unsigned char)(enc->acc >> enc->nbits);
+  }
+  if (enc->error) {
+    *nbytes = 0;
+    return NULL;
+  }
+  *nbytes = enc->offs;
+  return enc->buf;
+}
+
+static unsigned pwdc_huff_read(pwdc_huff_dec *dec, int len) {
+  if (dec->nbits < len) pwdc_huff_dec_refill(dec);
+  const unsigned v = (unsigned)(dec->acc >> (64 - len));
+  dec->acc <<= len;
+  dec->nbits -= len;
+  return v;
+}
+
+int pwdc_huff_dec_init(pwdc_huff_dec *dec, const unsigned char *buf,
+                       uint32_t nbytes) {
+  dec->buf = buf;
+  dec->end = buf + nbytes;
+  dec->acc = 0;
+  dec->nbits = 0;
+  dec->num_groups = (int)pwdc_huff_read(dec, 16);
+  dec->groups = (pwdc_huff_group *)calloc(dec->num_groups + 1,
+                                          sizeof(*dec->groups));
+  if (dec->groups == NULL) return -1;
+  for (int c = 0; c < dec->num_groups; c++) {
+    pwdc_huff_group *g = &dec->groups[c];
+    uint8_t lens[16];
+    uint16_t codes[16];
+    int kraft = 0;
+    g->nsyms = (int)pwdc_huff_read(dec, 4) + 1;
+    /*At least one bit, so the lookup shift stays in range.*/
+    g->bits = 1;
+    for (int i = 0; i < g->nsyms; i++) {
+      lens[i] = (uint8_t)pwdc_huff_read(dec, 4);
+      if (lens[i] > PWDC_HUFF_MAX_LEN) goto fail;
+      if (lens[i] > 0) kraft += 1 << (PWDC_HUFF_MAX_LEN - lens[i]);
+      g->bits = OD_MAXI(g->bits, lens[i]);
+    }
+    if (kraft > 1 << PWDC_HUFF_MAX_LEN) goto fail;
+    pwdc_huff_build_codes(lens, g->nsyms, codes);
+    /*Every codeword covers the entries whose top bits it is; entries no
+       codeword covers are only reached by corrupt streams.*/
+    g->table = (uint16_t *)calloc((size_t)1 << g->bits, sizeof(*g->table));
+    if (g->table == NULL) goto fail;
+    for (int i = 0; i < g->nsyms; i++) {
+      if (lens[i] == 0) continue;
+      const int shift = g->bits - lens[i];
+      const uint16_t e = (uint16_t)(i | lens[i] << 8);
+      for (int j = codes[i] << shift; j < (codes[i] + 1) << shift; j++) {
+        g->table[j] = e;
+      }
+    }
+  }
+  return 0;
+fail:
+  /*The groups before this one already have their tables.*/
+  pwdc_huff_dec_clear(dec);
+  return -1;
+}
+
+void pwdc_huff_dec_clear(pwdc_huff_dec *dec) {
+  if (dec->groups != NULL) {
+    for (int c = 0; c < dec->num_groups; c++) free(dec->groups[c].table);
+  }
+  free(dec->groups);
+  dec->groups = NULL;
+}
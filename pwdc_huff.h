@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef AOM_AOM_DSP_PWDC_HUFF_H_
+#define AOM_AOM_DSP_PWDC_HUFF_H_
+
+#include "aom_dsp/entenc_pipe.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*PWDC prefix-code backend.
+  The symbols of a tile are buffered as for pwdc_static.h, each tagged with
+   its context. Every context is a channel group: its histogram is the
+   channel_hits of that group (the symbol to channel mapping is one-to-one
+   for a fixed alphabet), and it gets a length-limited canonical Huffman code.
+  Stream layout, MSB first:
+   16 bits: number of groups
+   per group: 4 bits nsyms - 1, then 4 bits of code length per symbol
+    (0 for symbols that never occur)
+   the symbols in coding order: a group's codeword, or one raw bit for bools.
+  Decoding is a single table lookup per symbol.*/
+
+/*The longest codeword; also log2 of the largest decode table.*/
+#define PWDC_HUFF_MAX_LEN (11)
+
+/*Computes Huffman code lengths for hist[0..n-1], limited to max_len bits.
+  Symbols with a zero count get length 0. A lone symbol gets length 1.*/
+void pwdc_huff_build_lengths(const uint32_t *hist, int n, int max_len,
+                             uint8_t *lens);
+
+/*Assigns canonical codewords from code lengths.*/
+void pwdc_huff_build_codes(const uint8_t *lens, int n, uint16_t *codes);
+
+typedef struct {
+  unsigned char *buf;
+  uint32_t storage;
+  uint32_t offs;
+  /*The 64-bit bit buffer: the low nbits bits are pending output.*/
+  uint64_t acc;
+  int nbits;
+  int error;
+} pwdc_huff_enc;
+
+void pwdc_huff_enc_init(pwdc_huff_enc *enc, uint32_t size) OD_ARG_NONNULL(1);
+void pwdc_huff_enc_clear(pwdc_huff_enc *enc) OD_ARG_NONNULL(1);
+
+/*Starts buffering: resets sb, turns on context tracking and attaches it to
+   ec, so the aom_writer wrapping ec records its symbols. Returns 0 on
+   success.*/
+int pwdc_huff_begin(od_ec_symbuf *sb, od_ec_enc *ec) OD_ARG_NONNULL(1)
+    OD_ARG_NONNULL(2);
+
+/*Detaches sb from ec and codes every buffered symbol into enc. Returns 0 on
+   success.*/
+int pwdc_huff_encode(pwdc_huff_enc *enc, od_ec_symbuf *sb, od_ec_enc *ec)
+    OD_ARG_NONNULL(1) OD_ARG_NONNULL(2) OD_ARG_NONNULL(3);
+
+/*The exact size pwdc_huff_encode() would produce for the buffered symbols,
+   in bits, without coding them. Returns -1 on failure.*/
+OD_WARN_UNUSED_RESULT int64_t pwdc_huff_cost(const od_ec_symbuf *sb)
+    OD_ARG_NONNULL(1);
+
+OD_WARN_UNUSED_RESULT unsigned char *pwdc_huff_enc_done(pwdc_huff_enc *enc,
+                                                        uint32_t *nbytes)
+    OD_ARG_NONNULL(1) OD_ARG_NONNULL(2);
+
+typedef struct {
+  /*Decode table entries are symbol | length << 8.*/
+  uint16_t *table;
+  int bits;
+  int nsyms;
+} pwdc_huff_group;
+
+typedef struct {
+  const unsigned char *buf;
+  const unsigned char *end;
+  /*Left-aligned bit buffer holding nbits valid bits.*/
+  uint64_t acc;
+  int nbits;
+  pwdc_huff_group *groups;
+  int num_groups;
+} pwdc_huff_dec;
+
+/*Parses the group descriptions and builds the decode tables. Returns 0 on
+   success. On failure nothing is left allocated, and dec->groups is NULL.*/
+int pwdc_huff_dec_init(pwdc_huff_dec *dec, const unsigned char *buf,
+                       uint32_t nbytes) OD_ARG_NONNULL(1) OD_ARG_NONNULL(2);
+void pwdc_huff_dec_clear(pwdc_huff_dec *dec) OD_ARG_NONNULL(1);
+
+static inline void pwdc_huff_dec_refill(pwdc_huff_dec *dec) {
+  while (dec->nbits <= 56) {
+    const uint64_t byte = dec->buf < dec->end ? *dec->buf++ : 0;
+    dec->acc |= byte << (56 - dec->nbits);
+    dec->nbits += 8;
+  }
+}
+
+/*Decodes one symbol of group ctx, or one raw bit if ctx is 0.*/
+static inline int pwdc_huff_decode(pwdc_huff_dec *dec, int ctx) {
+  int s;
+  int len;
+  if (dec->nbits < PWDC_HUFF_MAX_LEN) pwdc_huff_dec_refill(dec);
+  if (ctx == 0) {
+    s = (int)(dec->acc >> 63);
+    len = 1;
+  } else {
+    const pwdc_huff_group *g = &dec->groups[ctx - 1];
+    const uint16_t e = g->table[dec->acc >> (64 - g->bits)];
+    s = e & 0xFF;
+    len = e >> 8;
+  }
+  dec->acc <<= len;
+  dec->nbits -= len;
+  return s;
+}
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_AOM_DSP_PWDC_HUFF_H_
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+/*pwdc_huff_test: round trips and throughput of the prefix-code backend (see
+   pwdc_huff.h), against the range coder.
+  Usage: pwdc_huff_test [num_symbols]
+  Writes num_symbols adaptive symbols (default 1000000) over 16-, 4- and
+   2-ary contexts, with raw bits mixed in, through an aom_writer into a symbol
+   buffer. The buffer is coded both with the prefix coder and, by draining it,
+   with the range coder, and each stream is decoded and checked. Prints the
+   sizes and symbols/s of each coder.
+  Also checks the length limit on a Fibonacci histogram, and that a corrupt
+   group description is rejected without leaking the groups before it.*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aom_dsp/bitwriter.h"
+#include "aom_dsp/entdec.h"
+#include "aom_dsp/pwdc_huff.h"
+#include "aom_ports/aom_timer.h"
+
+#define PWDC_HUFF_TEST_CONTEXTS (48)
+
+typedef struct {
+  uint8_t ctx;
+  uint8_t s;
+  /*A raw bit written before the symbol, or -1.*/
+  int8_t bit;
+} pwdc_huff_test_sym;
+
+static uint32_t pwdc_huff_test_rand(uint32_t *seed) {
+  *seed = *seed * 1103515245 + 12345;
+  return *seed >> 8;
+}
+
+static int pwdc_huff_test_nsyms(int c) {
+  return c % 3 == 0 ? 16 : c % 3 == 1 ? 4 : 2;
+}
+
+static void pwdc_huff_test_init_cdfs(aom_cdf_prob (*cdfs)[CDF_SIZE(16)]) {
+  memset(cdfs, 0, PWDC_HUFF_TEST_CONTEXTS * sizeof(*cdfs));
+  for (int c = 0; c < PWDC_HUFF_TEST_CONTEXTS; c++) {
+    const int n = pwdc_huff_test_nsyms(c);
+    for (int i = 0; i < n - 1; i++) {
+      cdfs[c][i] = AOM_ICDF((i + 1) * CDF_PROB_TOP / n);
+    }
+  }
+}
+
+static double pwdc_huff_test_rate(uint32_t n, struct aom_usec_timer *timer) {
+  const int64_t usec = aom_usec_timer_elapsed(timer);
+  return usec > 0 ? n / (double)usec : 0;
+}
+
+static int pwdc_huff_test_round_trip(uint32_t n) {
+  aom_cdf_prob(*cdfs)[CDF_SIZE(16)] = (aom_cdf_prob(*)[CDF_SIZE(16)])malloc(
+      PWDC_HUFF_TEST_CONTEXTS * sizeof(*cdfs));
+  pwdc_huff_test_sym *syms =
+      (pwdc_huff_test_sym *)malloc(n * sizeof(*syms));
+  /*The group of each context: contexts are numbered in order of first use.*/
+  int groups[PWDC_HUFF_TEST_CONTEXTS] = { 0 };
+  int num_groups = 0;
+  aom_writer w;
+  od_ec_symbuf sb;
+  od_ec_enc ref;
+  pwdc_huff_enc henc;
+  pwdc_huff_dec hdec;
+  od_ec_dec rdec;
+  struct aom_usec_timer timer;
+  uint32_t seed = 5;
+  uint32_t num_records = 0;
+  uint32_t huff_bytes;
+  uint32_t range_bytes;
+  int ret = -1;
+  memset(&w, 0, sizeof(w));
+  memset(&hdec, 0, sizeof(hdec));
+  od_ec_enc_init(&w.ec, 1024);
+  w.allow_update_cdf = 1;
+  od_ec_symbuf_init(&sb);
+  od_ec_enc_init(&ref, 1024);
+  pwdc_huff_enc_init(&henc, 1024);
+  if (cdfs == NULL || syms == NULL) goto done;
+  for (uint32_t i = 0; i < n; i++) {
+    const int c = (int)(pwdc_huff_test_rand(&seed) % PWDC_HUFF_TEST_CONTEXTS);
+    const int nsyms = pwdc_huff_test_nsyms(c);
+    int s = 0;
+    while (s < nsyms - 1 && pwdc_huff_test_rand(&seed) % (2 + c % 5) == 0) s++;
+    syms[i].ctx = (uint8_t)c;
+    syms[i].s = (uint8_t)s;
+    syms[i].bit = pwdc_huff_test_rand(&seed) % 10 == 0
+                      ? (int8_t)(pwdc_huff_test_rand(&seed) & 1)
+                      : -1;
+  }
+
+  pwdc_huff_test_init_cdfs(cdfs);
+  if (pwdc_huff_begin(&sb, &w.ec)) goto done;
+  for (uint32_t i = 0; i < n; i++) {
+    const pwdc_huff_test_sym *sym = &syms[i];
+    if (sym->bit >= 0) {
+      aom_write_bit(&w, sym->bit);
+      num_records++;
+    }
+    aom_write_symbol(&w, sym->s, cdfs[sym->ctx],
+                     pwdc_huff_test_nsyms(sym->ctx));
+    if (groups[sym->ctx] == 0) groups[sym->ctx] = ++num_groups;
+    num_records++;
+  }
+
+  aom_usec_timer_start(&timer);
+  od_ec_symbuf_drain(&sb, &ref);
+  unsigned char *range_buf = od_ec_enc_done(&ref, &range_bytes);
+  aom_usec_timer_mark(&timer);
+  const double range_enc_rate = pwdc_huff_test_rate(num_records, &timer);
+  aom_usec_timer_start(&timer);
+  if (pwdc_huff_encode(&henc, &sb, &w.ec)) goto done;
+  unsigned char *huff_buf = pwdc_huff_enc_done(&henc, &huff_bytes);
+  aom_usec_timer_mark(&timer);
+  const double huff_enc_rate = pwdc_huff_test_rate(num_records, &timer);
+  if (range_buf == NULL || huff_buf == NULL) {
+    fprintf(stderr, "coding failed\n");
+    goto done;
+  }
+
+  aom_usec_timer_start(&timer);
+  if (pwdc_huff_dec_init(&hdec, huff_buf, huff_bytes)) {
+    fprintf(stderr, "prefix code tables rejected\n");
+    goto done;
+  }
+  if (hdec.num_groups != num_groups) {
+    fprintf(stderr, "%d groups, expected %d\n", hdec.num_groups, num_groups);
+    goto done;
+  }
+  for (uint32_t i = 0; i < n; i++) {
+    const pwdc_huff_test_sym *sym = &syms[i];
+    if ((sym->bit >= 0 && pwdc_huff_decode(&hdec, 0) != sym->bit) ||
+        pwdc_huff_decode(&hdec, groups[sym->ctx]) != sym->s) {
+      fprintf(stderr, "prefix coder: symbol %u mismatch\n", i);
+      goto done;
+    }
+  }
+  aom_usec_timer_mark(&timer);
+  const double huff_dec_rate = pwdc_huff_test_rate(num_records, &timer);
+
+  pwdc_huff_test_init_cdfs(cdfs);
+  aom_usec_timer_start(&timer);
+  od_ec_dec_init(&rdec, range_buf, range_bytes);
+  for (uint32_t i = 0; i < n; i++) {
+    const pwdc_huff_test_sym *sym = &syms[i];
+    const int nsyms = pwdc_huff_test_nsyms(sym->ctx);
+    if (sym->bit >= 0 && od_ec_decode_bool_q15(&rdec, 16384) != sym->bit) {
+      fprintf(stderr, "range coder: bit %u mismatch\n", i);
+      goto done;
+    }
+    const int s = od_ec_decode_cdf_q15(&rdec, cdfs[sym->ctx], nsyms);
+    if (s != sym->s) {
+      fprintf(stderr, "range coder: symbol %u mismatch\n", i);
+      goto done;
+    }
+    update_cdf(cdfs[sym->ctx], (int8_t)s, nsyms);
+  }
+  aom_usec_timer_mark(&timer);
+  const double range_dec_rate = pwdc_huff_test_rate(num_records, &timer);
+
+  printf("%u records: prefix %u bytes, range %u bytes (%+.2f%%)\n",
+         num_records, huff_bytes, range_bytes,
+         100.0 * ((double)huff_bytes - range_bytes) / range_bytes);
+  printf("encode: prefix %.1f Msym/s, range %.1f Msym/s\n", huff_enc_rate,
+         range_enc_rate);
+  printf("decode: prefix %.1f Msym/s, range %.1f Msym/s\n", huff_dec_rate,
+         range_dec_rate);
+  ret = 0;
+done:
+  pwdc_huff_dec_clear(&hdec);
+  pwdc_huff_enc_clear(&henc);
+  od_ec_enc_clear(&ref);
+  od_ec_symbuf_clear(&sb);
+  od_ec_enc_clear(&w.ec);
+  free(syms);
+  free(cdfs);
+  return ret;
+}
+
+/*Fibonacci counts need a 15-bit code unless the lengths are limited.*/
+static int pwdc_huff_test_length_limit(void) {
+  uint32_t hist[16];
+  uint8_t lens[16];
+  uint32_t a = 1;
+  uint32_t b = 1;
+  int kraft = 0;
+  for (int i = 0; i < 16; i++) {
+    const uint32_t t = a + b;
+    hist[i] = a;
+    b = a;
+    a = t;
+  }
+  pwdc_huff_build_lengths(hist, 16, PWDC_HUFF_MAX_LEN, lens);
+  for (int i = 0; i < 16; i++) {
+    if (lens[i] < 1 || lens[i] > PWDC_HUFF_MAX_LEN) {
+      fprintf(stderr, "length limit: symbol %d has length %d\n", i, lens[i]);
+      return -1;
+    }
+    kraft += 1 << (PWDC_HUFF_MAX_LEN - lens[i]);
+  }
+  if (kraft > 1 << PWDC_HUFF_MAX_LEN) {
+    fprintf(stderr, "length limit: Kraft sum %d/%d\n", kraft,
+            1 << PWDC_HUFF_MAX_LEN);
+    return -1;
+  }
+  return 0;
+}
+
+/*Two groups: a valid 2-symbol one, then one with a 15-bit length. The first
+   group's table is built before the second is rejected.*/
+static int pwdc_huff_test_corrupt(void) {
+  static const unsigned char buf[] = { 0x00, 0x02, 0x11, 0x10, 0xF0 };
+  pwdc_huff_dec dec;
+  if (!pwdc_huff_dec_init(&dec, buf, sizeof(buf))) {
+    fprintf(stderr, "corrupt group description accepted\n");
+    pwdc_huff_dec_clear(&dec);
+    return -1;
+  }
+  if (dec.groups != NULL) {
+    fprintf(stderr, "corrupt group description left groups allocated\n");
+    return -1;
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  const long n = argc > 1 ? strtol(argv[1], NULL, 0) : 1000000;
+  if (n < 1 || n > (1 << 28)) {
+    fprintf(stderr, "Usage: %s [num_symbols]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (pwdc_huff_test_round_trip((uint32_t)n)) return EXIT_FAILURE;
+  if (pwdc_huff_test_length_limit()) return EXIT_FAILURE;
+  if (pwdc_huff_test_corrupt()) return EXIT_FAILURE;
+  printf("pwdc_huff_test: OK\n");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,459 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aom_dsp/pwdc_model.h"
+
+/*The longest Exp-Golomb prefix the decoder accepts, enough for any
+   uint32_t.*/
+#define PWDC_MODEL_EG0_MAX_PREFIX (31)
+/*Cached models are ranked on every PWDC_MODEL_SAMPLE-th context, and only
+   the best PWDC_MODEL_FINALISTS are priced on all of them.*/
+#define PWDC_MODEL_SAMPLE (16)
+#define PWDC_MODEL_FINALISTS (2)
+
+typedef struct pwdc_model pwdc_model;
+
+struct pwdc_model {
+  pwdc_model *prev;
+  pwdc_model *next;
+  uint32_t id;
+  uint32_t n;
+  pwdc_table *tables;
+};
+
+struct pwdc_model_cache {
+  /*Most recently used first.*/
+  pwdc_model *head;
+  pwdc_model *tail;
+  size_t budget;
+  size_t bytes;
+  uint32_t next_id;
+  /*-log2(f / PWDC_TABLE_TOP) for each frequency f, in bits.*/
+  double cost[PWDC_TABLE_TOP + 1];
+};
+
+/*The encoder's view of a context in the current frame.*/
+typedef struct {
+  const uint32_t *count;
+  int nsyms;
+  uint16_t freq[16];
+  /*Ideal cost of the frame's symbols with freq, and of freq in a NEW header,
+     in bits.*/
+  double bits;
+  int new_bits;
+} pwdc_model_ctx;
+
+static int pwdc_model_eg0_bits(uint32_t v) {
+  return 2 * (OD_ILOG_NZ(v + 1) - 1) + 1;
+}
+
+static void pwdc_model_write_eg0(od_ec_enc *enc, uint32_t v) {
+  const int n = OD_ILOG_NZ(v + 1) - 1;
+  for (int i = 0; i < n; i++) od_ec_encode_bool_q15(enc, 0, 16384);
+  for (int i = n; i >= 0; i--) {
+    od_ec_encode_bool_q15(enc, ((v + 1) >> i) & 1, 16384);
+  }
+}
+
+static int pwdc_model_read_eg0(od_ec_dec *dec, uint32_t *v) {
+  int n = 0;
+  while (!od_ec_decode_bool_q15(dec, 16384)) {
+    if (++n > PWDC_MODEL_EG0_MAX_PREFIX) return -1;
+  }
+  uint32_t x = 1;
+  for (int i = 0; i < n; i++) x = x << 1 | od_ec_decode_bool_q15(dec, 16384);
+  *v = x - 1;
+  return 0;
+}
+
+static uint32_t pwdc_model_zigzag(int d) {
+  return d >= 0 ? 2 * (uint32_t)d : 2 * (uint32_t)-d - 1;
+}
+
+static int pwdc_model_unzigzag(uint32_t u) {
+  return u & 1 ? -(int)((u >> 1) + 1) : (int)(u >> 1);
+}
+
+static size_t pwdc_model_size(uint32_t n) {
+  return sizeof(pwdc_model) + n * sizeof(pwdc_table);
+}
+
+static pwdc_model *pwdc_model_alloc(uint32_t n) {
+  pwdc_model *m = (pwdc_model *)calloc(1, sizeof(*m));
+  if (m == NULL) return NULL;
+  m->tables = (pwdc_table *)malloc(n * sizeof(*m->tables));
+  if (m->tables == NULL) {
+    free(m);
+    return NULL;
+  }
+  m->n = n;
+  return m;
+}
+
+static void pwdc_model_free(pwdc_model *m) {
+  if (m == NULL) return;
+  free(m->tables);
+  free(m);
+}
+
+static void pwdc_model_unlink(pwdc_model_cache *c, pwdc_model *m) {
+  if (m->prev != NULL) {
+    m->prev->next = m->next;
+  } else {
+    c->head = m->next;
+  }
+  if (m->next != NULL) {
+    m->next->prev = m->prev;
+  } else {
+    c->tail = m->prev;
+  }
+  m->prev = m->next = NULL;
+}
+
+static void pwdc_model_push_front(pwdc_model_cache *c, pwdc_model *m) {
+  m->prev = NULL;
+  m->next = c->head;
+  if (c->head != NULL) {
+    c->head->prev = m;
+  } else {
+    c->tail = m;
+  }
+  c->head = m;
+}
+
+static pwdc_model *pwdc_model_find(const pwdc_model_cache *c, uint32_t id) {
+  for (pwdc_model *m = c->head; m != NULL; m = m->next) {
+    if (m->id == id) return m;
+  }
+  return NULL;
+}
+
+/*Makes the frame's model current: ref (if any) was used, and m (if any) is
+   new. The encoder and the decoder both end every frame here, so their
+   caches stay identical.*/
+static void pwdc_model_commit(pwdc_model_cache *c, pwdc_model *ref,
+                              pwdc_model *m) {
+  if (ref != NULL) {
+    pwdc_model_unlink(c, ref);
+    pwdc_model_push_front(c, ref);
+  }
+  if (m != NULL) {
+    m->id = c->next_id++;
+    pwdc_model_push_front(c, m);
+    c->bytes += pwdc_model_size(m->n);
+  }
+  while (c->bytes > c->budget && c->tail != c->head) {
+    pwdc_model *victim = c->tail;
+    pwdc_model_unlink(c, victim);
+    c->bytes -= pwdc_model_size(victim->n);
+    pwdc_model_free(victim);
+  }
+}
+
+pwdc_model_cache *pwdc_model_cache_create(size_t budget) {
+  pwdc_model_cache *c = (pwdc_model_cache *)calloc(1, sizeof(*c));
+  if (c == NULL) return NULL;
+  c->budget = budget;
+  /*A zero frequency can only be used for symbols that do not occur.*/
+  c->cost[0] = HUGE_VAL;
+  for (int f = 1; f <= PWDC_TABLE_TOP; f++) {
+    c->cost[f] = -log2((double)f / PWDC_TABLE_TOP);
+  }
+  return c;
+}
+
+void pwdc_model_cache_destroy(pwdc_model_cache *c) {
+  if (c == NULL) return;
+  while (c->head != NULL) {
+    pwdc_model *m = c->head;
+    c->head = m->next;
+    pwdc_model_free(m);
+  }
+  free(c);
+}
+
+size_t pwdc_model_cache_memory_usage(const pwdc_model_cache *c) {
+  return c->bytes;
+}
+
+static double pwdc_model_symbol_bits(const pwdc_model_cache *c,
+                                     const uint32_t *count, int nsyms,
+                                     const uint16_t *freq) {
+  double bits = 0;
+  for (int i = 0; i < nsyms; i++) {
+    if (count[i] > 0) bits += count[i] * c->cost[freq[i]];
+  }
+  return bits;
+}
+
+/*Bits to describe cur as a change to old in a DELTA header, not counting
+   the changed flag.*/
+static int pwdc_model_delta_bits(const pwdc_model_ctx *cur,
+                                 const pwdc_table *old) {
+  int bits = 0;
+  for (int i = 0; i < cur->nsyms - 1; i++) {
+    bits += pwdc_model_eg0_bits(
+        pwdc_model_zigzag((int)cur->freq[i] - (int)old->freq[i]));
+  }
+  return bits;
+}
+
+/*Whether a DELTA from old should send cur for this context: when the
+   symbols cost more with the old table than with the new one plus its
+   description. *stale is set to the cost with the old table, and *bits to
+   the cost of the choice, in bits.*/
+static int pwdc_model_changed(const pwdc_model_cache *c,
+                              const pwdc_model_ctx *cur,
+                              const pwdc_table *old, double *stale,
+                              double *bits) {
+  *stale = pwdc_model_symbol_bits(c, cur->count, cur->nsyms, old->freq);
+  const double fresh = cur->bits + pwdc_model_delta_bits(cur, old);
+  *bits = fresh < *stale ? fresh : *stale;
+  return fresh < *stale;
+}
+
+/*Total cost of the frame with ref as the reference, as REF and as DELTA,
+   in bits, over every stride-th context. Returns 0 if ref cannot be a
+   reference.*/
+static int pwdc_model_ref_bits(const pwdc_model_cache *c,
+                               const pwdc_model_ctx *ctx, uint32_t n,
+                               uint32_t stride, const pwdc_model *ref,
+                               double *ref_bits, double *delta_bits) {
+  if (ref->n != n) return 0;
+  const int id_bits = pwdc_model_eg0_bits(c->next_id - 1 - ref->id);
+  double stale = id_bits + pwdc_model_eg0_bits(PWDC_MODEL_REF);
+  double delta = id_bits + pwdc_model_eg0_bits(PWDC_MODEL_DELTA) + (double)n;
+  for (uint32_t i = 0; i < n; i += stride) {
+    const pwdc_table *old = &ref->tables[i];
+    double old_bits;
+    double bits;
+    if (old->nsyms != ctx[i].nsyms) return 0;
+    pwdc_model_changed(c, &ctx[i], old, &old_bits, &bits);
+    stale += old_bits;
+    delta += bits;
+  }
+  *ref_bits = stale;
+  *delta_bits = delta;
+  return 1;
+}
+
+int pwdc_model_encode(pwdc_model_cache *c, const pwdc_table_hist *hists,
+                      uint32_t n, od_ec_enc *enc, const pwdc_table **tables,
+                      pwdc_model_report *report) {
+  if (n == 0 || n > PWDC_MODEL_MAX_CONTEXTS) return -1;
+  pwdc_model_ctx *ctx = (pwdc_model_ctx *)malloc(n * sizeof(*ctx));
+  if (ctx == NULL) return -1;
+  int new_header_bits =
+      pwdc_model_eg0_bits(PWDC_MODEL_NEW) + pwdc_model_eg0_bits(n - 1);
+  double new_bits = 0;
+  for (uint32_t i = 0; i < n; i++) {
+    pwdc_model_ctx *x = &ctx[i];
+    x->count = hists[i].count;
+    x->nsyms = OD_MINI(OD_MAXI(hists[i].nsyms, 1), 16);
+    pwdc_table_normalize(x->count, x->nsyms, x->freq);
+    x->bits = pwdc_model_symbol_bits(c, x->count, x->nsyms, x->freq);
+    x->new_bits = pwdc_model_eg0_bits(x->nsyms - 1);
+    for (int k = 0; k < x->nsyms - 1; k++) {
+      x->new_bits += pwdc_model_eg0_bits(x->freq[k]);
+    }
+    new_header_bits += x->new_bits;
+    new_bits += x->bits;
+  }
+
+  /*Price the most promising cached models as references against sending a
+     NEW one.*/
+  pwdc_model *finalist[PWDC_MODEL_FINALISTS] = { NULL };
+  double score[PWDC_MODEL_FINALISTS] = { 0 };
+  for (pwdc_model *m = c->head; m != NULL; m = m->next) {
+    double ref_bits;
+    double delta_bits;
+    if (!pwdc_model_ref_bits(c, ctx, n, PWDC_MODEL_SAMPLE, m, &ref_bits,
+                             &delta_bits)) {
+      continue;
+    }
+    /*Insert into the finalists, which are kept best first.*/
+    pwdc_model *x = m;
+    double s = ref_bits < delta_bits ? ref_bits : delta_bits;
+    for (int k = 0; k < PWDC_MODEL_FINALISTS && x != NULL; k++) {
+      if (finalist[k] == NULL || s < score[k]) {
+        pwdc_model *t = finalist[k];
+        const double u = score[k];
+        finalist[k] = x;
+        score[k] = s;
+        x = t;
+        s = u;
+      }
+    }
+  }
+  pwdc_model_mode mode = PWDC_MODEL_NEW;
+  pwdc_model *ref = NULL;
+  double best = new_header_bits + new_bits;
+  for (int k = 0; k < PWDC_MODEL_FINALISTS && finalist[k] != NULL; k++) {
+    double ref_bits;
+    double delta_bits;
+    /*The sample may have missed a context whose alphabet changed.*/
+    if (!pwdc_model_ref_bits(c, ctx, n, 1, finalist[k], &ref_bits,
+                             &delta_bits)) {
+      continue;
+    }
+    if (ref_bits <= best) {
+      best = ref_bits;
+      mode = PWDC_MODEL_REF;
+      ref = finalist[k];
+    }
+    if (delta_bits < best) {
+      best = delta_bits;
+      mode = PWDC_MODEL_DELTA;
+      ref = finalist[k];
+    }
+  }
+
+  pwdc_model *m = NULL;
+  if (mode != PWDC_MODEL_REF) {
+    m = pwdc_model_alloc(n);
+    if (m == NULL) {
+      free(ctx);
+      return -1;
+    }
+  }
+  const int start = od_ec_enc_tell(enc);
+  uint32_t builds = 0;
+  double symbol_bits = 0;
+  pwdc_model_write_eg0(enc, mode);
+  if (ref != NULL) pwdc_model_write_eg0(enc, c->next_id - 1 - ref->id);
+  if (mode == PWDC_MODEL_NEW) pwdc_model_write_eg0(enc, n - 1);
+  for (uint32_t i = 0; i < n; i++) {
+    const pwdc_model_ctx *x = &ctx[i];
+    int build = mode == PWDC_MODEL_NEW;
+    if (ref != NULL) {
+      const pwdc_table *old = &ref->tables[i];
+      double old_bits;
+      double bits;
+      if (mode == PWDC_MODEL_DELTA) {
+        build = pwdc_model_changed(c, x, old, &old_bits, &bits);
+        m->tables[i] = *old;
+        od_ec_encode_bool_q15(enc, build, 16384);
+        for (int k = 0; build && k < x->nsyms - 1; k++) {
+          pwdc_model_write_eg0(
+              enc, pwdc_model_zigzag((int)x->freq[k] - (int)old->freq[k]));
+        }
+      }
+      if (!build) {
+        symbol_bits +=
+            pwdc_model_symbol_bits(c, x->count, x->nsyms, old->freq);
+      }
+    } else {
+      pwdc_model_write_eg0(enc, x->nsyms - 1);
+      for (int k = 0; k < x->nsyms - 1; k++) {
+        pwdc_model_write_eg0(enc, x->freq[k]);
+      }
+    }
+    if (build) {
+      pwdc_table *t = &m->tables[i];
+      t->nsyms = x->nsyms;
+      memcpy(t->freq, x->freq, sizeof(t->freq));
+      pwdc_table_fill(t);
+      symbol_bits += x->bits;
+      builds++;
+    }
+  }
+  if (report != NULL) {
+    report->mode = mode;
+    report->ref_id = ref != NULL ? ref->id : 0;
+    report->id = m != NULL ? c->next_id : 0;
+    report->num_contexts = n;
+    report->builds = builds;
+    report->header_bits = (uint32_t)(od_ec_enc_tell(enc) - start);
+    report->new_header_bits = (uint32_t)new_header_bits;
+    report->symbol_bits = symbol_bits;
+  }
+  pwdc_model_commit(c, ref, m);
+  *tables = (m != NULL ? m : ref)->tables;
+  free(ctx);
+  return enc->error ? -1 : 0;
+}
+
+/*Reads the nsyms - 1 leading frequencies of t, as values (old == NULL) or as
+   changes to old, and fills t.*/
+static int pwdc_model_read_table(od_ec_dec *dec, pwdc_table *t,
+                                 const pwdc_table *old) {
+  int sum = 0;
+  for (int k = 0; k < t->nsyms - 1; k++) {
+    uint32_t v;
+    if (pwdc_model_read_eg0(dec, &v) || v > 2 * PWDC_TABLE_TOP) return -1;
+    const int f =
+        old != NULL ? old->freq[k] + pwdc_model_unzigzag(v) : (int)v;
+    if (f < 0 || f > PWDC_TABLE_TOP - sum) return -1;
+    t->freq[k] = (uint16_t)f;
+    sum += f;
+  }
+  t->freq[t->nsyms - 1] = (uint16_t)(PWDC_TABLE_TOP - sum);
+  pwdc_table_fill(t);
+  return 0;
+}
+
+int pwdc_model_decode(pwdc_model_cache *c, od_ec_dec *dec,
+                      const pwdc_table **tables, uint32_t *n) {
+  uint32_t mode;
+  uint32_t v;
+  pwdc_model *ref = NULL;
+  if (pwdc_model_read_eg0(dec, &mode) || mode > PWDC_MODEL_NEW) return -1;
+  if (mode != PWDC_MODEL_NEW) {
+    if (pwdc_model_read_eg0(dec, &v) || v >= c->next_id) return -1;
+    ref = pwdc_model_find(c, c->next_id - 1 - v);
+    if (ref == NULL) return -1;
+  }
+  if (mode == PWDC_MODEL_REF) {
+    pwdc_model_commit(c, ref, NULL);
+    *tables = ref->tables;
+    *n = ref->n;
+    return 0;
+  }
+  uint32_t count;
+  if (mode == PWDC_MODEL_DELTA) {
+    count = ref->n;
+  } else {
+    if (pwdc_model_read_eg0(dec, &v) || v >= PWDC_MODEL_MAX_CONTEXTS) {
+      return -1;
+    }
+    count = v + 1;
+  }
+  pwdc_model *m = pwdc_model_alloc(count);
+  if (m == NULL) return -1;
+  for (uint32_t i = 0; i < count; i++) {
+    pwdc_table *t = &m->tables[i];
+    int err;
+    if (mode == PWDC_MODEL_DELTA) {
+      *t = ref->tables[i];
+      if (!od_ec_decode_bool_q15(dec, 16384)) continue;
+      err = pwdc_model_read_table(dec, t, &ref->tables[i]);
+    } else {
+      memset(t->freq, 0, sizeof(t->freq));
+      err = pwdc_model_read_eg0(dec, &v) || v > 15;
+      if (!err) {
+        t->nsyms = (int)v + 1;
+        err = pwdc_model_read_table(dec, t, NULL);
+      }
+    }
+    if (err) {
+      pwdc_model_free(m);
+      return -1;
+    }
+  }
+  pwdc_model_commit(c, ref, m);
+  *tables = m->tables;
+  *n = count;
+  return 0;
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef AOM_AOM_DSP_PWDC_MODEL_H_
+#define AOM_AOM_DSP_PWDC_MODEL_H_
+
+#include <stddef.h>
+
+#include "aom_dsp/entdec.h"
+#include "aom_dsp/pwdc_table.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*Cross-frame model cache.
+  A model is the set of static tables (pwdc_table.h) a frame codes with, one
+   per context. The encoder and the decoder each keep a cache of the models
+   sent so far, numbered in the order they were sent. A frame's model header
+   then takes one of three forms, whichever makes the frame cheapest:
+   REF: a cached model, used as is
+   DELTA: a cached model, with new tables for the contexts that drifted
+   NEW: every table
+  A DELTA or NEW model joins the cache under the next ID. Every model used is
+   moved to the front of the cache, and the least recently used ones are
+   evicted while the cache is over its byte budget. Both sides follow the same
+   rules, so they stay in step without any of this being signaled; the
+   decoder's cache must be created with the encoder's budget.
+  A context keeps its cached table while coding its symbols with it costs no
+   more than describing a new one would save. Only the tables that change are
+   built; the rest are copied.
+  Header syntax, all raw bools with Exp-Golomb values as in pwdc_static.c:
+   mode (0 REF, 1 DELTA, 2 NEW)
+   REF, DELTA: newest ID - reference ID
+   DELTA: per context, a changed flag, then for changed contexts nsyms - 1
+    frequency differences, zigzag mapped
+   NEW: the number of contexts, then per context nsyms - 1 and nsyms - 1
+    frequencies
+  Each context's last frequency is what is left of PWDC_TABLE_TOP.*/
+
+typedef enum {
+  PWDC_MODEL_REF,
+  PWDC_MODEL_DELTA,
+  PWDC_MODEL_NEW,
+} pwdc_model_mode;
+
+/*The most contexts a NEW model may have.*/
+#define PWDC_MODEL_MAX_CONTEXTS (1 << 16)
+
+typedef struct pwdc_model_cache pwdc_model_cache;
+
+typedef struct {
+  pwdc_model_mode mode;
+  /*The reference model (REF, DELTA) and the ID the model got (DELTA, NEW).*/
+  uint32_t ref_id;
+  uint32_t id;
+  uint32_t num_contexts;
+  /*Tables built for this frame.*/
+  uint32_t builds;
+  /*Bits in the model header, and in the NEW header the frame would have
+     needed without the cache.*/
+  uint32_t header_bits;
+  uint32_t new_header_bits;
+  /*Ideal cost of the frame's symbols with the tables chosen, in bits.*/
+  double symbol_bits;
+} pwdc_model_report;
+
+/*Creates a cache holding up to budget bytes of models. At least the model in
+   use is always kept. Returns NULL on failure.*/
+pwdc_model_cache *pwdc_model_cache_create(size_t budget);
+void pwdc_model_cache_destroy(pwdc_model_cache *c);
+
+/*Bytes held by the cached models.*/
+size_t pwdc_model_cache_memory_usage(const pwdc_model_cache *c)
+    OD_ARG_NONNULL(1);
+
+/*Chooses the model for a frame with the histograms hists[0..n) and writes
+   its header to enc. *tables is set to the n tables to code the frame with,
+   which stay valid until the next call. report may be NULL.
+  Returns 0 on success.*/
+int pwdc_model_encode(pwdc_model_cache *c, const pwdc_table_hist *hists,
+                      uint32_t n, od_ec_enc *enc, const pwdc_table **tables,
+                      pwdc_model_report *report) OD_ARG_NONNULL(1)
+    OD_ARG_NONNULL(2) OD_ARG_NONNULL(4) OD_ARG_NONNULL(5);
+
+/*Reads a model header from dec, setting *tables and *n as
+   pwdc_model_encode() does. Returns 0 on success, or -1 if the header is
+   invalid or names a model that is not cached.*/
+int pwdc_model_decode(pwdc_model_cache *c, od_ec_dec *dec,
+                      const pwdc_table **tables, uint32_t *n)
+    OD_ARG_NONNULL(1) OD_ARG_NONNULL(2) OD_ARG_NONNULL(3) OD_ARG_NONNULL(4);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_AOM_DSP_PWDC_MODEL_H_
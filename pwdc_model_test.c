@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+/*pwdc_model_test: round trips of the cross-frame model cache (see
+   pwdc_model.h).
+  Usage: pwdc_model_test
+  Codes a sequence of drifting frames through an encoder and a decoder
+   cache, with budgets from a single model up, and checks that every frame
+   decodes to the encoder's tables. Then checks that a context changing its
+   alphabet rules out a reference whose sampled contexts all still match.*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aom_dsp/pwdc_model.h"
+
+static uint32_t pwdc_model_test_rand(uint32_t *seed) {
+  *seed = *seed * 1103515245 + 12345;
+  return *seed >> 8;
+}
+
+static int pwdc_model_test_same(const pwdc_table *a, const pwdc_table *b) {
+  return a->nsyms == b->nsyms && a->hash == b->hash &&
+         !memcmp(a->freq, b->freq, sizeof(a->freq)) &&
+         !memcmp(a->icdf, b->icdf, sizeof(a->icdf)) &&
+         !memcmp(a->lens, b->lens, sizeof(a->lens)) &&
+         !memcmp(a->codes, b->codes, sizeof(a->codes)) &&
+         !memcmp(a->spread, b->spread, sizeof(a->spread));
+}
+
+/*Codes one frame through both caches. Returns 0 if the decoder got the
+   encoder's tables, and every context's symbols are codable with them.*/
+static int pwdc_model_test_frame(pwdc_model_cache *enc_cache,
+                                 pwdc_model_cache *dec_cache,
+                                 const pwdc_table_hist *hists, uint32_t n,
+                                 pwdc_model_report *report) {
+  od_ec_enc enc;
+  od_ec_dec dec;
+  const pwdc_table *enc_tables;
+  const pwdc_table *dec_tables;
+  uint32_t dec_n;
+  uint32_t nbytes;
+  int ret = -1;
+  od_ec_enc_init(&enc, 1024);
+  if (pwdc_model_encode(enc_cache, hists, n, &enc, &enc_tables, report)) {
+    goto done;
+  }
+  unsigned char *buf = od_ec_enc_done(&enc, &nbytes);
+  if (buf == NULL) goto done;
+  od_ec_dec_init(&dec, buf, nbytes);
+  if (pwdc_model_decode(dec_cache, &dec, &dec_tables, &dec_n)) goto done;
+  if (dec_n != n) goto done;
+  for (uint32_t i = 0; i < n; i++) {
+    const pwdc_table *t = &enc_tables[i];
+    if (!pwdc_model_test_same(t, &dec_tables[i])) goto done;
+    if (t->nsyms != hists[i].nsyms) goto done;
+    for (int s = 0; s < t->nsyms; s++) {
+      if (hists[i].count[s] > 0 && t->freq[s] == 0) goto done;
+    }
+  }
+  if (pwdc_model_cache_memory_usage(enc_cache) !=
+      pwdc_model_cache_memory_usage(dec_cache)) {
+    goto done;
+  }
+  ret = 0;
+done:
+  od_ec_enc_clear(&enc);
+  return ret;
+}
+
+static int pwdc_model_test_drift(size_t budget) {
+  const uint32_t n = 300;
+  pwdc_table_hist *hists = (pwdc_table_hist *)calloc(n, sizeof(*hists));
+  pwdc_model_cache *enc_cache = pwdc_model_cache_create(budget);
+  pwdc_model_cache *dec_cache = pwdc_model_cache_create(budget);
+  uint32_t seed = 1;
+  int modes[3] = { 0 };
+  int ret = -1;
+  if (hists == NULL || enc_cache == NULL || dec_cache == NULL) goto done;
+  for (int f = 0; f < 60; f++) {
+    /*Two scenes, with counts resampled every frame.*/
+    const uint32_t scene = (f / 10) & 1;
+    pwdc_model_report report;
+    for (uint32_t i = 0; i < n; i++) {
+      pwdc_table_hist *h = &hists[i];
+      memset(h->count, 0, sizeof(h->count));
+      h->nsyms = 2 + i % 15;
+      for (int s = 0; s < h->nsyms; s++) {
+        const uint32_t base = (1000 >> ((s * (1 + (i + scene) % 3)) & 15));
+        h->count[s] = base + pwdc_model_test_rand(&seed) % (1 + base / 8);
+      }
+    }
+    if (pwdc_model_test_frame(enc_cache, dec_cache, hists, n, &report)) {
+      fprintf(stderr, "budget %zu: frame %d did not round trip\n", budget, f);
+      goto done;
+    }
+    modes[report.mode]++;
+  }
+  if (modes[PWDC_MODEL_NEW] == 60) {
+    fprintf(stderr, "budget %zu: no frame used the cache\n", budget);
+    goto done;
+  }
+  ret = 0;
+done:
+  pwdc_model_cache_destroy(enc_cache);
+  pwdc_model_cache_destroy(dec_cache);
+  free(hists);
+  return ret;
+}
+
+/*Context 5 goes from 4 to 8 symbols. The models are ranked on a sample of
+   the contexts that skips it, so only the full pricing can see that the
+   cached model no longer fits.*/
+static int pwdc_model_test_alphabet_change(void) {
+  enum { N = 32 };
+  pwdc_table_hist hists[N];
+  pwdc_model_cache *enc_cache = pwdc_model_cache_create(1 << 20);
+  pwdc_model_cache *dec_cache = pwdc_model_cache_create(1 << 20);
+  pwdc_model_report report;
+  int ret = -1;
+  if (enc_cache == NULL || dec_cache == NULL) goto done;
+  memset(hists, 0, sizeof(hists));
+  for (int i = 0; i < N; i++) {
+    hists[i].nsyms = 4;
+    for (int s = 0; s < 4; s++) hists[i].count[s] = 400 >> s;
+  }
+  if (pwdc_model_test_frame(enc_cache, dec_cache, hists, N, &report)) {
+    goto done;
+  }
+  hists[5].nsyms = 8;
+  for (int s = 0; s < 8; s++) hists[5].count[s] = 100;
+  if (pwdc_model_test_frame(enc_cache, dec_cache, hists, N, &report)) {
+    fprintf(stderr, "alphabet change: frame did not round trip\n");
+    goto done;
+  }
+  if (report.mode != PWDC_MODEL_NEW) {
+    fprintf(stderr, "alphabet change: mode %d, expected NEW\n", report.mode);
+    goto done;
+  }
+  ret = 0;
+done:
+  pwdc_model_cache_destroy(enc_cache);
+  pwdc_model_cache_destroy(dec_cache);
+  return ret;
+}
+
+int main(void) {
+  static const size_t budgets[] = { 0, 1 << 19, 1 << 24 };
+  for (size_t b = 0; b < sizeof(budgets) / sizeof(*budgets); b++) {
+    if (pwdc_model_test_drift(budgets[b])) return EXIT_FAILURE;
+  }
+  if (pwdc_model_test_alphabet_change()) return EXIT_FAILURE;
+  printf("pwdc_model_test: OK\n");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+/*pwdc_orig_test: entenc.c against the original libaom coder
+   (entenc_original.c), byte for byte.
+  Usage: pwdc_orig_test REFERENCE_FILE
+  The two coders define the same functions, so the test is built twice (see
+   README.md). Built with PWDC_ORIG_TEST_REFERENCE against
+   entenc_original.c, it codes every case and writes the streams to
+   REFERENCE_FILE. Built against entenc.c, it codes the same cases, once as
+   is and once in bounded-carry mode (od_ec_enc_set_bounded_carry()), and
+   every stream must equal the reference.
+  Each case is a random mix of bools, including near-certain ones, CDF
+   symbols of 2 to 16 values, and raw bits. The original coder writes raw
+   bits as bools at one half, as aom_write_bit() did; entenc.c writes them
+   with od_ec_encode_bool_half(), which must give the same bytes.*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aom_dsp/entenc.h"
+
+static const int pwdc_orig_test_sizes[] = { 0, 1, 5, 100, 1000, 30000, 300000 };
+#define PWDC_ORIG_TEST_SEEDS (6)
+
+static uint32_t pwdc_orig_test_rand(uint32_t *seed) {
+  *seed = *seed * 1103515245 + 12345;
+  return *seed >> 8;
+}
+
+static void pwdc_orig_test_raw_bit(od_ec_enc *enc, int bit) {
+#if defined(PWDC_ORIG_TEST_REFERENCE)
+  od_ec_encode_bool_q15(enc, bit, 16384);
+#else
+  od_ec_encode_bool_half(enc, bit);
+#endif
+}
+
+/*Codes n random symbols drawn from seed.*/
+static void pwdc_orig_test_code(od_ec_enc *enc, uint32_t seed, int n) {
+  for (int i = 0; i < n; i++) {
+    const uint32_t r = pwdc_orig_test_rand(&seed);
+    switch (r % 8) {
+      case 0:
+      case 1:
+      case 2: {
+        unsigned f = 1 + pwdc_orig_test_rand(&seed) % 32767;
+        /*Near-certain bools make long runs of 0xFF bytes for carries to
+           ripple through.*/
+        if ((r >> 3) % 4 == 0) f = 32767 - (r >> 5) % 8;
+        od_ec_encode_bool_q15(enc, pwdc_orig_test_rand(&seed) % 8 != 0, f);
+        break;
+      }
+      case 3: pwdc_orig_test_raw_bit(enc, (r >> 3) & 1); break;
+      default: {
+        const int nsyms = 2 + (int)((r >> 3) % 15);
+        uint16_t icdf[16];
+        int cur = 32768;
+        for (int k = 0; k < nsyms - 1; k++) {
+          const int rem = nsyms - 1 - k;
+          int step = 1 + (int)(pwdc_orig_test_rand(&seed) %
+                               ((cur - rem) / (rem + 1) * 2 + 1));
+          if (cur - step < rem) step = 1;
+          cur -= step;
+          icdf[k] = (uint16_t)cur;
+        }
+        icdf[nsyms - 1] = 0;
+        int s = (int)(pwdc_orig_test_rand(&seed) % nsyms);
+        if (pwdc_orig_test_rand(&seed) % 3 == 0) s = 0;
+        od_ec_encode_cdf_q15(enc, s, icdf, nsyms);
+        break;
+      }
+    }
+  }
+}
+
+/*Codes case (seed, n) and returns the output, or NULL on failure.*/
+static const unsigned char *pwdc_orig_test_case(od_ec_enc *enc, uint32_t seed,
+                                                int n, int bounded,
+                                                uint32_t *nbytes) {
+  od_ec_enc_reset(enc);
+#if defined(PWDC_ORIG_TEST_REFERENCE)
+  (void)bounded;
+#else
+  od_ec_enc_set_bounded_carry(enc, bounded);
+#endif
+  pwdc_orig_test_code(enc, seed, n);
+  return od_ec_enc_done(enc, nbytes);
+}
+
+#define PWDC_ORIG_TEST_NUM_SIZES \
+  ((int)(sizeof(pwdc_orig_test_sizes) / sizeof(*pwdc_orig_test_sizes)))
+
+#if defined(PWDC_ORIG_TEST_REFERENCE)
+/*Writes every case to f, each as its size, 4 bytes little-endian, and its
+   bytes.*/
+static int pwdc_orig_test_run(od_ec_enc *enc, FILE *f) {
+  for (uint32_t seed = 1; seed <= PWDC_ORIG_TEST_SEEDS; seed++) {
+    for (int k = 0; k < PWDC_ORIG_TEST_NUM_SIZES; k++) {
+      unsigned char size_field[4];
+      uint32_t nbytes;
+      const unsigned char *out = pwdc_orig_test_case(
+          enc, seed, pwdc_orig_test_sizes[k], 0, &nbytes);
+      if (out == NULL) return -1;
+      for (int b = 0; b < 4; b++) {
+        size_field[b] = (unsigned char)(nbytes >> 8 * b);
+      }
+      if (fwrite(size_field, 1, 4, f) != 4 ||
+          fwrite(out, 1, nbytes, f) != nbytes) {
+        return -1;
+      }
+    }
+  }
+  printf("pwdc_orig_test: reference written\n");
+  return 0;
+}
+#else
+/*Codes every case in both modes and compares it with the stream in f.*/
+static int pwdc_orig_test_run(od_ec_enc *enc, FILE *f) {
+  unsigned char *ref = NULL;
+  int ret = -1;
+  for (uint32_t seed = 1; seed <= PWDC_ORIG_TEST_SEEDS; seed++) {
+    for (int k = 0; k < PWDC_ORIG_TEST_NUM_SIZES; k++) {
+      const int n = pwdc_orig_test_sizes[k];
+      unsigned char size_field[4];
+      uint32_t ref_bytes = 0;
+      if (fread(size_field, 1, 4, f) != 4) {
+        fprintf(stderr, "The reference ends before seed %u, %d symbols\n",
+                seed, n);
+        goto done;
+      }
+      for (int b = 0; b < 4; b++) {
+        ref_bytes |= (uint32_t)size_field[b] << 8 * b;
+      }
+      free(ref);
+      ref = (unsigned char *)malloc(ref_bytes + 1);
+      if (ref == NULL || fread(ref, 1, ref_bytes, f) != ref_bytes) goto done;
+      for (int bounded = 0; bounded <= 1; bounded++) {
+        uint32_t nbytes;
+        const unsigned char *out =
+            pwdc_orig_test_case(enc, seed, n, bounded, &nbytes);
+        if (out == NULL) {
+          fprintf(stderr, "seed %u, %d symbols: coding failed\n", seed, n);
+          goto done;
+        }
+        if (nbytes != ref_bytes || memcmp(out, ref, nbytes)) {
+          fprintf(stderr,
+                  "seed %u, %d symbols%s: %u bytes differ from the %u the "
+                  "original coder wrote\n",
+                  seed, n, bounded ? ", bounded carry" : "", nbytes,
+                  ref_bytes);
+          goto done;
+        }
+      }
+    }
+  }
+  printf("pwdc_orig_test: OK\n");
+  ret = 0;
+done:
+  free(ref);
+  return ret;
+}
+#endif
+
+int main(int argc, char **argv) {
+  od_ec_enc enc;
+  FILE *f;
+  int ret;
+  if (argc != 2) {
+    fprintf(stderr, "Usage: %s REFERENCE_FILE\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+#if defined(PWDC_ORIG_TEST_REFERENCE)
+  f = fopen(argv[1], "wb");
+#else
+  f = fopen(argv[1], "rb");
+#endif
+  if (f == NULL) {
+    fprintf(stderr, "Cannot open %s\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+  /*Start small so the output buffer grows during the longer cases.*/
+  od_ec_enc_init(&enc, 64);
+  ret = pwdc_orig_test_run(&enc, f);
+  if (fclose(f)) ret = -1;
+  od_ec_enc_clear(&enc);
+  return ret ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+/*pwdc_pipe_test: tiles coded through an od_ec_pipe (see entenc_pipe.h)
+   against the same tiles coded directly. Meant to be run under
+   ThreadSanitizer as well.
+  Usage: pwdc_pipe_test [num_symbols]
+  Writes tiles of up to num_symbols (default 200000) bools, raw bits and
+   adaptive symbols through an aom_writer, once with a pipe attached and once
+   without. The bytes must be identical, and so must the statistics
+   pwdc_stats_get() returns on the calling thread afterwards.
+  Then codes one tile with contexts tracked, through the pipe and by
+   draining the buffer on the calling thread, and the per-context counts
+   (see pwdc_ctx_stats_get()) must agree.*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aom_dsp/bitwriter.h"
+
+#define PWDC_PIPE_TEST_TILES (6)
+/*pwdc_pipe_test_write() uses 4 CDFs, numbered from 1.*/
+#define PWDC_PIPE_TEST_CONTEXTS (5)
+
+static uint32_t pwdc_pipe_test_rand(uint32_t *seed) {
+  *seed = *seed * 1103515245 + 12345;
+  return *seed >> 8;
+}
+
+/*Writes tile t into w. Runs of equal bools are common, so the bool-run
+   statistics straddle pipe blocks.*/
+static void pwdc_pipe_test_write(aom_writer *w, int t, uint32_t n) {
+  aom_cdf_prob cdfs[4][CDF_SIZE(4)];
+  uint32_t seed = 11 * t + 3;
+  for (int c = 0; c < 4; c++) {
+    cdfs[c][0] = AOM_ICDF(8192);
+    cdfs[c][1] = AOM_ICDF(16384);
+    cdfs[c][2] = AOM_ICDF(24576);
+    cdfs[c][3] = 0;
+    cdfs[c][4] = 0;
+  }
+  /*Tile 0 is empty.*/
+  n = t == 0 ? 0 : n / t;
+  for (uint32_t i = 0; i < n; i++) {
+    const uint32_t r = pwdc_pipe_test_rand(&seed);
+    switch (r % 4) {
+      case 0: {
+        const int len = 1 + (int)(pwdc_pipe_test_rand(&seed) % 40);
+        const int bit = pwdc_pipe_test_rand(&seed) & 1;
+        for (int k = 0; k < len; k++) aom_write(w, bit, 200);
+        break;
+      }
+      case 1: aom_write_bit(w, (r >> 8) & 1); break;
+      default:
+        aom_write_symbol(w, (int)((r >> 8) % 4), cdfs[(r >> 12) & 3], 4);
+        break;
+    }
+  }
+}
+
+/*Codes every tile, through pipe if it is not NULL, and returns the
+   concatenated output in *buf.*/
+static int pwdc_pipe_test_code(od_ec_pipe *pipe, uint32_t n,
+                               unsigned char **buf, uint32_t *size,
+                               pwdc_stats *stats) {
+  aom_writer w;
+  od_ec_symbuf sb;
+  int ret = -1;
+  *buf = NULL;
+  *size = 0;
+  memset(&w, 0, sizeof(w));
+  od_ec_enc_init(&w.ec, 1024);
+  w.allow_update_cdf = 1;
+  od_ec_symbuf_init(&sb);
+  pwdc_stats_reset();
+  for (int t = 0; t < PWDC_PIPE_TEST_TILES; t++) {
+    uint32_t nbytes;
+    od_ec_enc_reset(&w.ec);
+    if (pipe != NULL) od_ec_pipe_begin(pipe, &sb, &w.ec);
+    pwdc_pipe_test_write(&w, t, n);
+    if (pipe != NULL && od_ec_pipe_finish(pipe)) goto done;
+    const unsigned char *out = od_ec_enc_done(&w.ec, &nbytes);
+    if (out == NULL) goto done;
+    unsigned char *grown = (unsigned char *)realloc(*buf, *size + nbytes + 1);
+    if (grown == NULL) goto done;
+    *buf = grown;
+    memcpy(*buf + *size, out, nbytes);
+    *size += nbytes;
+  }
+  pwdc_stats_get(stats);
+  ret = 0;
+done:
+  od_ec_symbuf_clear(&sb);
+  od_ec_enc_clear(&w.ec);
+  return ret;
+}
+
+static int pwdc_pipe_test_stats(uint32_t n) {
+  od_ec_pipe *pipe = od_ec_pipe_create();
+  unsigned char *ref_buf = NULL;
+  unsigned char *buf = NULL;
+  uint32_t ref_size;
+  uint32_t size;
+  pwdc_stats ref;
+  pwdc_stats stats;
+  int ret = -1;
+  if (pipe == NULL) goto done;
+  if (pwdc_pipe_test_code(NULL, n, &ref_buf, &ref_size, &ref) ||
+      pwdc_pipe_test_code(pipe, n, &buf, &size, &stats)) {
+    fprintf(stderr, "stats: coding failed\n");
+    goto done;
+  }
+  if (size != ref_size || memcmp(buf, ref_buf, size)) {
+    fprintf(stderr, "stats: %u bytes through the pipe, %u coded directly\n",
+            size, ref_size);
+    goto done;
+  }
+  if (memcmp(&stats, &ref, sizeof(ref))) {
+    fprintf(stderr,
+            "stats: %llu symbols, %llu bool runs through the pipe; "
+            "%llu, %llu coded directly\n",
+            (unsigned long long)stats.total_symbols,
+            (unsigned long long)stats.bool_runs,
+            (unsigned long long)ref.total_symbols,
+            (unsigned long long)ref.bool_runs);
+    goto done;
+  }
+  ret = 0;
+done:
+  free(buf);
+  free(ref_buf);
+  od_ec_pipe_destroy(pipe);
+  return ret;
+}
+
+/*Codes tile 1 into sb, through pipe if it is not NULL and by draining sb
+   otherwise, counting by context into cs.*/
+static int pwdc_pipe_test_code_contexts(od_ec_pipe *pipe, od_ec_symbuf *sb,
+                                        pwdc_ctx_stats *cs, uint32_t n) {
+  aom_writer w;
+  uint32_t nbytes;
+  int ret = -1;
+  memset(&w, 0, sizeof(w));
+  od_ec_enc_init(&w.ec, 1024);
+  w.allow_update_cdf = 1;
+  sb->ctx_stats = cs;
+  if (pipe != NULL) {
+    od_ec_pipe_begin(pipe, sb, &w.ec);
+  } else {
+    od_ec_symbuf_reset(sb);
+    w.ec.symbuf = sb;
+  }
+  pwdc_pipe_test_write(&w, 1, n);
+  if (pipe != NULL) {
+    if (od_ec_pipe_finish(pipe)) goto done;
+  } else {
+    w.ec.symbuf = NULL;
+    if (sb->error) goto done;
+    od_ec_symbuf_drain(sb, &w.ec);
+  }
+  if (od_ec_enc_done(&w.ec, &nbytes) == NULL) goto done;
+  ret = 0;
+done:
+  od_ec_enc_clear(&w.ec);
+  return ret;
+}
+
+static int pwdc_pipe_test_contexts(uint32_t n) {
+  od_ec_pipe *pipe = od_ec_pipe_create();
+  pwdc_ctx_stats *ref = pwdc_ctx_stats_create(PWDC_PIPE_TEST_CONTEXTS);
+  pwdc_ctx_stats *cs = pwdc_ctx_stats_create(PWDC_PIPE_TEST_CONTEXTS);
+  od_ec_symbuf sb;
+  uint64_t total = 0;
+  int ret = -1;
+  od_ec_symbuf_init(&sb);
+  if (pipe == NULL || ref == NULL || cs == NULL) goto done;
+  if (od_ec_symbuf_track_contexts(&sb) ||
+      pwdc_pipe_test_code_contexts(NULL, &sb, ref, n) ||
+      pwdc_pipe_test_code_contexts(pipe, &sb, cs, n)) {
+    fprintf(stderr, "contexts: coding failed\n");
+    goto done;
+  }
+  for (uint32_t c = 0; c < PWDC_PIPE_TEST_CONTEXTS; c++) {
+    uint64_t want[16];
+    uint64_t got[16];
+    pwdc_ctx_stats_get(ref, c, want);
+    pwdc_ctx_stats_get(cs, c, got);
+    for (int i = 0; i < 16; i++) {
+      if (got[i] != want[i]) {
+        fprintf(stderr,
+                "contexts: context %u symbol %d counted %llu times through "
+                "the pipe, %llu when drained\n",
+                c, i, (unsigned long long)got[i], (unsigned long long)want[i]);
+        goto done;
+      }
+      total += got[i];
+    }
+  }
+  if (total == 0) {
+    fprintf(stderr, "contexts: nothing counted\n");
+    goto done;
+  }
+  ret = 0;
+done:
+  od_ec_symbuf_clear(&sb);
+  pwdc_ctx_stats_destroy(cs);
+  pwdc_ctx_stats_destroy(ref);
+  od_ec_pipe_destroy(pipe);
+  return ret;
+}
+
+int main(int argc, char **argv) {
+  const long n = argc > 1 ? strtol(argv[1], NULL, 0) : 200000;
+  if (n < 1 || n > (1 << 26)) {
+    fprintf(stderr, "Usage: %s [num_symbols]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (pwdc_pipe_test_stats((uint32_t)n)) return EXIT_FAILURE;
+  if (pwdc_pipe_test_contexts((uint32_t)n)) return EXIT_FAILURE;
+  printf("pwdc_pipe_test: OK\n");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+/*pwdc_query: aggregates PWDC stats stores (see pwdc_store.h).
+  Usage: pwdc_query [--encode ID] FILE...
+  Sums every column over all frames, or over the frames of one encode, and
+   prints the totals and the channel distribution. The files are mapped and
+   the columns summed in place.*/
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aom_dsp/pwdc_store.h"
+
+static uint64_t pwdc_query_sum(const uint64_t *col, uint32_t n) {
+  uint64_t sum = 0;
+  for (uint32_t i = 0; i < n; i++) sum += col[i];
+  return sum;
+}
+
+static uint64_t pwdc_query_sum_encode(const uint64_t *col, const uint64_t *ids,
+                                      uint32_t n, uint64_t id) {
+  uint64_t sum = 0;
+  for (uint32_t i = 0; i < n; i++) sum += ids[i] == id ? col[i] : 0;
+  return sum;
+}
+
+int main(int argc, char **argv) {
+  uint64_t totals[PWDC_STORE_COLS] = { 0 };
+  uint64_t frames = 0;
+  uint64_t encode_id = 0;
+  int filter = 0;
+  int nfiles = 0;
+  for (int a = 1; a < argc; a++) {
+    if (!strcmp(argv[a], "--encode") && a + 1 < argc) {
+      encode_id = strtoull(argv[++a], NULL, 0);
+      filter = 1;
+      continue;
+    }
+    pwdc_store_map m;
+    if (pwdc_store_map_open(&m, argv[a])) {
+      fprintf(stderr, "%s: not a readable PWDC stats store\n", argv[a]);
+      return EXIT_FAILURE;
+    }
+    nfiles++;
+    for (uint32_t b = 0; b < m.num_blocks; b++) {
+      const pwdc_store_block *blk = &m.index[b];
+      const uint32_t n = blk->num_frames;
+      if (!filter) {
+        for (int c = 0; c < PWDC_STORE_COLS; c++) {
+          totals[c] += pwdc_query_sum(pwdc_store_column(&m, b, c), n);
+        }
+        frames += n;
+        continue;
+      }
+      if (encode_id < blk->encode_min || encode_id > blk->encode_max) continue;
+      const uint64_t *ids = pwdc_store_column(&m, b, PWDC_STORE_COL_ENCODE_ID);
+      for (uint32_t i = 0; i < n; i++) frames += ids[i] == encode_id;
+      for (int c = 0; c < PWDC_STORE_COLS; c++) {
+        totals[c] += pwdc_query_sum_encode(pwdc_store_column(&m, b, c), ids, n,
+                                           encode_id);
+      }
+    }
+    pwdc_store_map_close(&m);
+  }
+  if (nfiles == 0) {
+    fprintf(stderr, "usage: %s [--encode ID] FILE...\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  const uint64_t symbols = totals[PWDC_STORE_COL_TOTAL_SYMBOLS];
+  const uint64_t bytes = totals[PWDC_STORE_COL_BYTES];
+  const uint64_t *bools = &totals[PWDC_STORE_COL_BOOL_COUNT];
+  const uint64_t *hits = &totals[PWDC_STORE_COL_CHANNEL_HITS];
+  uint64_t total_hits = 0;
+  for (int ch = 0; ch < 128; ch++) total_hits += hits[ch];
+  printf("files          %d\n", nfiles);
+  printf("frames         %" PRIu64 "\n", frames);
+  printf("symbols        %" PRIu64 "\n", symbols);
+  printf("bytes          %" PRIu64 "\n", bytes);
+  printf("bits/symbol    %.4f\n", symbols ? 8.0 * bytes / symbols : 0.0);
+  printf("bools          %" PRIu64 " zeros, %" PRIu64 " ones\n", bools[0],
+         bools[1]);
+  double entropy = 0;
+  printf("channel        hits            share\n");
+  for (int ch = 0; ch < 128; ch++) {
+    if (hits[ch] == 0) continue;
+    const double p = (double)hits[ch] / total_hits;
+    entropy -= p * log2(p);
+    printf("%7d        %-15" PRIu64 " %6.3f%%\n", ch, hits[ch], 100 * p);
+  }
+  printf("channel entropy %.4f bits\n", entropy);
+  return EXIT_SUCCESS;
+}
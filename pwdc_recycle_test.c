@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+/*pwdc_recycle_test: buffer growth and shrinking across od_ec_enc_recycle().
+  Usage: pwdc_recycle_test
+  - After od_ec_enc_done(), recycling must raise the high-water mark to the
+     full output size, the bytes od_ec_enc_done() writes last included.
+  - Encodes whose sizes vary by +-20% must settle on one buffer and never
+     reallocate it.
+  - A spike 20 times that size must grow the buffer, keep it for a few
+     encodes, release it within 20, and settle again without reallocating.
+  - Every recycled encode must give the same bytes as a fresh encoder.*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aom_dsp/entenc.h"
+
+/*Symbols per steady encode, and the size pattern they vary by, in percent.*/
+#define PWDC_RECYCLE_TEST_SYMBOLS (20000)
+static const int pwdc_recycle_test_pcts[] = { 100, 80, 115, 95, 120, 90, 105 };
+#define PWDC_RECYCLE_TEST_NUM_PCTS \
+  ((int)(sizeof(pwdc_recycle_test_pcts) / sizeof(*pwdc_recycle_test_pcts)))
+
+static uint32_t pwdc_recycle_test_rand(uint32_t *seed) {
+  *seed = *seed * 1103515245 + 12345;
+  return *seed >> 8;
+}
+
+static const unsigned char *pwdc_recycle_test_code(od_ec_enc *enc,
+                                                   uint32_t seed, int n,
+                                                   uint32_t *nbytes) {
+  static const uint16_t icdf[8] = { 28000, 23000, 18000, 13000,
+                                    9000,  5000,  2000,  0 };
+  for (int i = 0; i < n; i++) {
+    const uint32_t r = pwdc_recycle_test_rand(&seed);
+    if (r % 4 == 0) {
+      od_ec_encode_bool_q15(enc, (r >> 2) & 1, 1 + (r >> 3) % 32767);
+    } else {
+      od_ec_encode_cdf_q15(enc, (int)((r >> 2) % 8), icdf, 8);
+    }
+  }
+  return od_ec_enc_done(enc, nbytes);
+}
+
+/*Codes case (seed, n) into enc, checks it against a fresh encoder, then
+   recycles enc.*/
+static int pwdc_recycle_test_encode(od_ec_enc *enc, uint32_t seed, int n,
+                                    uint32_t *nbytes) {
+  od_ec_enc ref;
+  uint32_t ref_bytes;
+  int ret = -1;
+  const unsigned char *out = pwdc_recycle_test_code(enc, seed, n, nbytes);
+  od_ec_enc_init(&ref, 1024);
+  const unsigned char *ref_out =
+      pwdc_recycle_test_code(&ref, seed, n, &ref_bytes);
+  if (out == NULL || ref_out == NULL) {
+    fprintf(stderr, "seed %u, %d symbols: coding failed\n", seed, n);
+  } else if (*nbytes != ref_bytes || memcmp(out, ref_out, ref_bytes)) {
+    fprintf(stderr, "seed %u, %d symbols: differs from a fresh encoder\n",
+            seed, n);
+  } else {
+    ret = 0;
+  }
+  od_ec_enc_clear(&ref);
+  od_ec_enc_recycle(enc);
+  return ret;
+}
+
+/*A 1-byte starting size leaves the mark to the encode alone.*/
+static int pwdc_recycle_test_hwm(void) {
+  static const int sizes[] = { 0, 1, 3, 40, 1000, 50000 };
+  for (int k = 0; k < (int)(sizeof(sizes) / sizeof(*sizes)); k++) {
+    od_ec_enc enc;
+    uint32_t nbytes;
+    od_ec_enc_init(&enc, 1);
+    const int ret = pwdc_recycle_test_encode(&enc, 7, sizes[k], &nbytes);
+    const uint32_t hwm = enc.hwm;
+    od_ec_enc_clear(&enc);
+    if (ret) return -1;
+    if (hwm != OD_MAXI(nbytes, 1)) {
+      fprintf(stderr, "%d symbols: high-water mark %u, output %u bytes\n",
+              sizes[k], hwm, nbytes);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/*Runs one cycle of steady encodes, and fails if any reallocates when
+   settled is set. Returns the largest output in *max_bytes.*/
+static int pwdc_recycle_test_steady(od_ec_enc *enc, uint32_t *seed,
+                                    int settled, uint32_t *max_bytes) {
+  *max_bytes = 0;
+  for (int k = 0; k < PWDC_RECYCLE_TEST_NUM_PCTS; k++) {
+    const int n = PWDC_RECYCLE_TEST_SYMBOLS * pwdc_recycle_test_pcts[k] / 100;
+    const size_t before = od_ec_enc_memory_usage(enc);
+    uint32_t nbytes;
+    if (pwdc_recycle_test_encode(enc, (*seed)++, n, &nbytes)) return -1;
+    if (settled && od_ec_enc_memory_usage(enc) != before) {
+      fprintf(stderr, "steady encode of %d symbols: buffer %zu -> %zu\n", n,
+              before, od_ec_enc_memory_usage(enc));
+      return -1;
+    }
+    *max_bytes = OD_MAXI(*max_bytes, nbytes);
+  }
+  return 0;
+}
+
+static int pwdc_recycle_test_spike(void) {
+  od_ec_enc enc;
+  uint32_t seed = 100;
+  uint32_t steady_bytes;
+  uint32_t spike_bytes;
+  int released = 0;
+  int ret = -1;
+  od_ec_enc_init(&enc, 1024);
+  /*One cycle to grow, then nothing may change.*/
+  if (pwdc_recycle_test_steady(&enc, &seed, 0, &steady_bytes) ||
+      pwdc_recycle_test_steady(&enc, &seed, 1, &steady_bytes) ||
+      pwdc_recycle_test_steady(&enc, &seed, 1, &steady_bytes)) {
+    goto done;
+  }
+  const size_t steady = od_ec_enc_memory_usage(&enc);
+  if (pwdc_recycle_test_encode(&enc, seed++, 20 * PWDC_RECYCLE_TEST_SYMBOLS,
+                               &spike_bytes)) {
+    goto done;
+  }
+  if (od_ec_enc_memory_usage(&enc) < spike_bytes) {
+    fprintf(stderr, "spike: %zu byte buffer for %u bytes\n",
+            od_ec_enc_memory_usage(&enc), spike_bytes);
+    goto done;
+  }
+  /*Released once the buffer is back below half the spike.*/
+  for (int i = 1; i <= 20 && !released; i++) {
+    uint32_t nbytes;
+    const int n = PWDC_RECYCLE_TEST_SYMBOLS;
+    if (pwdc_recycle_test_encode(&enc, seed++, n, &nbytes)) goto done;
+    if (od_ec_enc_memory_usage(&enc) < spike_bytes / 2) {
+      if (i < 3) {
+        fprintf(stderr, "spike: released after %d encodes\n", i);
+        goto done;
+      }
+      released = 1;
+    }
+  }
+  if (!released) {
+    fprintf(stderr, "spike: %zu byte buffer kept after 20 encodes\n",
+            od_ec_enc_memory_usage(&enc));
+    goto done;
+  }
+  /*Later shrinks follow the decaying mark down; give them time, then check
+     the buffer has settled no larger than one shrink above the steady size.*/
+  for (int cycle = 0; cycle < 10; cycle++) {
+    if (pwdc_recycle_test_steady(&enc, &seed, 0, &steady_bytes)) goto done;
+  }
+  if (pwdc_recycle_test_steady(&enc, &seed, 1, &steady_bytes) ||
+      pwdc_recycle_test_steady(&enc, &seed, 1, &steady_bytes)) {
+    goto done;
+  }
+  if (od_ec_enc_memory_usage(&enc) > 3 * (size_t)steady_bytes + 4096) {
+    fprintf(stderr, "spike: settled on %zu bytes, %zu before, for %u\n",
+            od_ec_enc_memory_usage(&enc), steady, steady_bytes);
+    goto done;
+  }
+  ret = 0;
+done:
+  od_ec_enc_clear(&enc);
+  return ret;
+}
+
+int main(void) {
+  if (pwdc_recycle_test_hwm() || pwdc_recycle_test_spike()) {
+    return EXIT_FAILURE;
+  }
+  printf("pwdc_recycle_test: OK\n");
+  return EXIT_SUCCESS;
+}
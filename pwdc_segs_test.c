@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+/*pwdc_segs_test: scatter-gather output of the tile pool (see
+   od_ec_tile_pool_segments() and od_ec_tile_segs_write() in entenc_mt.h).
+  Usage: pwdc_segs_test [num_threads]
+  Codes frames of tiles, some of them empty, with num_threads workers
+   (default 4), and for each size field width:
+  - the segments, with a header segment and an empty one added, written to a
+     file must read back as the header followed by od_ec_tile_pool_stitch()'s
+     output, with more segments than one writev() call takes;
+  - too few segments must be rejected;
+  - with RLIMIT_FSIZE set partway through, the write must stop with EFBIG
+     after a partial write, leaving exactly the bytes up to the limit.
+  POSIX only.*/
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "aom_dsp/entenc_mt.h"
+
+#define PWDC_SEGS_TEST_TILES (150)
+#define PWDC_SEGS_TEST_MAX_SEGS (2 * PWDC_SEGS_TEST_TILES + 2)
+
+static const unsigned char pwdc_segs_test_header[] = { 0x32, 0x10, 0xA5 };
+
+static uint32_t pwdc_segs_test_rand(uint32_t *seed) {
+  *seed = *seed * 1103515245 + 12345;
+  return *seed >> 8;
+}
+
+/*Every seventh tile codes nothing.*/
+static int pwdc_segs_test_tile(void *priv, int tile_idx, aom_writer *w) {
+  aom_cdf_prob cdf[CDF_SIZE(4)] = { AOM_CDF4(8192, 16384, 24576) };
+  uint32_t seed = 13 * tile_idx + *(const int *)priv;
+  const int n = tile_idx % 7 == 0 ? 0 : (tile_idx * 131) % 3000;
+  for (int i = 0; i < n; i++) {
+    aom_write_symbol(w, pwdc_segs_test_rand(&seed) % 4, cdf, 4);
+  }
+  return 0;
+}
+
+/*Reads the whole of f into buf, returning the number of bytes.*/
+static size_t pwdc_segs_test_read(FILE *f, unsigned char *buf, size_t size) {
+  rewind(f);
+  return fread(buf, 1, size, f);
+}
+
+/*Builds the segment list: the header, an empty segment, then the pool's.*/
+static int pwdc_segs_test_segments(od_ec_tile_pool *pool, od_ec_tile_seg *segs,
+                                   int tile_size_bytes) {
+  segs[0].data = pwdc_segs_test_header;
+  segs[0].nbytes = sizeof(pwdc_segs_test_header);
+  segs[1].data = pwdc_segs_test_header;
+  segs[1].nbytes = 0;
+  const int nsegs = od_ec_tile_pool_segments(
+      pool, segs + 2, PWDC_SEGS_TEST_MAX_SEGS - 2, tile_size_bytes);
+  return nsegs < 0 ? -1 : nsegs + 2;
+}
+
+/*Writes segs to a fresh file, with RLIMIT_FSIZE set to limit unless it is
+   0, and reads the file back into buf. Returns what
+   od_ec_tile_segs_write() returned, with its errno in *err.*/
+static int pwdc_segs_test_write(const od_ec_tile_seg *segs, int nsegs,
+                                rlim_t limit, unsigned char *buf, size_t size,
+                                size_t *nread, int *err) {
+  struct rlimit old;
+  FILE *f = tmpfile();
+  int ret;
+  *nread = 0;
+  *err = 0;
+  if (f == NULL || getrlimit(RLIMIT_FSIZE, &old)) {
+    if (f != NULL) fclose(f);
+    *err = errno;
+    return -2;
+  }
+  if (limit > 0) {
+    struct rlimit lim = old;
+    lim.rlim_cur = limit;
+    setrlimit(RLIMIT_FSIZE, &lim);
+  }
+  errno = 0;
+  ret = od_ec_tile_segs_write(fileno(f), segs, nsegs);
+  *err = errno;
+  if (limit > 0) setrlimit(RLIMIT_FSIZE, &old);
+  *nread = pwdc_segs_test_read(f, buf, size);
+  fclose(f);
+  return ret;
+}
+
+static int pwdc_segs_test_frame(od_ec_tile_pool *pool, int frame) {
+  od_ec_tile_seg segs[PWDC_SEGS_TEST_MAX_SEGS];
+  unsigned char *ref = NULL;
+  unsigned char *buf = NULL;
+  int ret = -1;
+  if (od_ec_tile_pool_encode(pool, PWDC_SEGS_TEST_TILES, NULL,
+                             pwdc_segs_test_tile, &frame)) {
+    fprintf(stderr, "frame %d: coding failed\n", frame);
+    return -1;
+  }
+  for (int tile_size_bytes = 0; tile_size_bytes <= 4; tile_size_bytes++) {
+    size_t total = 0;
+    for (int i = 0; i < PWDC_SEGS_TEST_TILES; i++) {
+      uint32_t nbytes;
+      od_ec_tile_pool_get_tile(pool, i, &nbytes);
+      total += nbytes;
+    }
+    total += sizeof(pwdc_segs_test_header) +
+             (size_t)tile_size_bytes * (PWDC_SEGS_TEST_TILES - 1);
+    free(ref);
+    free(buf);
+    ref = (unsigned char *)malloc(total);
+    buf = (unsigned char *)malloc(total + 1);
+    if (ref == NULL || buf == NULL) goto done;
+    memcpy(ref, pwdc_segs_test_header, sizeof(pwdc_segs_test_header));
+    const size_t hdr = sizeof(pwdc_segs_test_header);
+    const int64_t stitched = od_ec_tile_pool_stitch(
+        pool, ref + hdr, total - hdr, tile_size_bytes, NULL);
+    /*A size that does not fit is rejected by both.*/
+    if (stitched < 0) {
+      if (pwdc_segs_test_segments(pool, segs, tile_size_bytes) >= 0) {
+        fprintf(stderr, "frame %d, %d byte sizes: segments not rejected\n",
+                frame, tile_size_bytes);
+        goto done;
+      }
+      continue;
+    }
+    if ((size_t)stitched != total - hdr) {
+      fprintf(stderr, "frame %d, %d byte sizes: stitched %lld bytes of %zu\n",
+              frame, tile_size_bytes, (long long)stitched, total - hdr);
+      goto done;
+    }
+    int nsegs = pwdc_segs_test_segments(pool, segs, tile_size_bytes);
+    if (nsegs < 0 || od_ec_tile_pool_segments(pool, segs, nsegs - 3,
+                                              tile_size_bytes) >= 0) {
+      fprintf(stderr, "frame %d, %d byte sizes: segment count not checked\n",
+              frame, tile_size_bytes);
+      goto done;
+    }
+    nsegs = pwdc_segs_test_segments(pool, segs, tile_size_bytes);
+    size_t nread;
+    int err;
+    if (pwdc_segs_test_write(segs, nsegs, 0, buf, total + 1, &nread, &err) ||
+        nread != total || memcmp(buf, ref, total)) {
+      fprintf(stderr,
+              "frame %d, %d byte sizes: %zu bytes read back of %zu (%s)\n",
+              frame, tile_size_bytes, nread, total, strerror(err));
+      goto done;
+    }
+    /*Stop partway through a segment of a later writev() batch.*/
+    const rlim_t limit = (rlim_t)(total * 3 / 4);
+    if (pwdc_segs_test_write(segs, nsegs, limit, buf, total + 1, &nread,
+                             &err) != -1 ||
+        err != EFBIG || nread != limit || memcmp(buf, ref, nread)) {
+      fprintf(stderr,
+              "frame %d, %d byte sizes: %zu bytes of %zu written over a "
+              "limit of %zu (%s)\n",
+              frame, tile_size_bytes, nread, total, (size_t)limit,
+              strerror(err));
+      goto done;
+    }
+  }
+  ret = 0;
+done:
+  free(ref);
+  free(buf);
+  return ret;
+}
+
+int main(int argc, char **argv) {
+  const int num_threads = argc > 1 ? atoi(argv[1]) : 4;
+  od_ec_tile_pool *pool;
+  int ret = EXIT_FAILURE;
+  if (num_threads < 1) {
+    fprintf(stderr, "Usage: %s [num_threads]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  /*Writes past RLIMIT_FSIZE fail with EFBIG instead of killing us.*/
+  signal(SIGXFSZ, SIG_IGN);
+  pool = od_ec_tile_pool_create(num_threads);
+  if (pool == NULL) return EXIT_FAILURE;
+  for (int frame = 1; frame <= 3; frame++) {
+    if (pwdc_segs_test_frame(pool, frame)) goto done;
+  }
+  printf("pwdc_segs_test: OK\n");
+  ret = EXIT_SUCCESS;
+done:
+  od_ec_tile_pool_destroy(pool);
+  return ret;
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <string.h>
+
+#include "aom_dsp/pwdc_select.h"
+
+void pwdc_select_config_init(pwdc_select_config *cfg) {
+  cfg->threshold_bp = PWDC_SELECT_THRESHOLD_BP;
+  cfg->speed = 0;
+}
+
+int64_t pwdc_select_range_cost(const od_ec_symbuf *sb) {
+  uint16_t cost[OD_EC_COST_PROB_TOP + 1];
+  int64_t cost_q8 = 0;
+  od_ec_cost_init(cost);
+  const od_ec_symbuf_block *blk = sb->head;
+  for (uint32_t b = 0; blk != NULL && b <= sb->nblocks; b++) {
+    const uint32_t n = b < sb->nblocks ? OD_EC_SYMBUF_BLOCK_SIZE
+                                       : (uint32_t)(sb->pos - blk->syms);
+    for (uint32_t i = 0; i < n; i++) {
+      cost_q8 += od_ec_sym_cost_q8(cost, &blk->syms[i]);
+    }
+    blk = blk->next;
+  }
+  return od_ec_cost_bits(cost_q8);
+}
+
+pwdc_coder pwdc_select_decide(const pwdc_select_config *cfg,
+                              int64_t range_bits, int64_t huff_bits) {
+  if (cfg->threshold_bp < 0 || huff_bits < 0) return PWDC_CODER_RANGE;
+  const int speed = OD_CLAMPI(0, cfg->speed, PWDC_SELECT_MAX_SPEED);
+  const int64_t gate_bp =
+      cfg->threshold_bp + (int64_t)speed * PWDC_SELECT_SPEED_STEP_BP;
+  return huff_bits * 10000 <= range_bits * (10000 + gate_bp)
+             ? PWDC_CODER_HUFF
+             : PWDC_CODER_RANGE;
+}
+
+int pwdc_select_encode(od_ec_symbuf *sb, od_ec_enc *ec, pwdc_huff_enc *henc,
+                       const pwdc_select_config *cfg,
+                       pwdc_select_report *report) {
+  ec->symbuf = NULL;
+  if (sb->error) return -1;
+  const int64_t range_bits = pwdc_select_range_cost(sb);
+  /*Skip the prefix code analysis when the gate is off.*/
+  const int64_t huff_bits = cfg->threshold_bp < 0 ? -1 : pwdc_huff_cost(sb);
+  const pwdc_coder coder = pwdc_select_decide(cfg, range_bits, huff_bits);
+  if (report != NULL) {
+    report->coder = coder;
+    report->range_bits = range_bits;
+    report->huff_bits = huff_bits;
+  }
+  if (coder == PWDC_CODER_HUFF) {
+    if (pwdc_huff_encode(henc, sb, ec)) return -1;
+  } else {
+    od_ec_symbuf_drain(sb, ec);
+    if (ec->error) return -1;
+  }
+  return coder;
+}
+
+int64_t pwdc_select_write(unsigned char *dst, size_t dst_size,
+                          pwdc_coder coder, od_ec_enc *ec,
+                          pwdc_huff_enc *henc) {
+  const unsigned char *payload;
+  uint32_t nbytes;
+  if (coder == PWDC_CODER_HUFF) {
+    payload = pwdc_huff_enc_done(henc, &nbytes);
+  } else {
+    payload = od_ec_enc_done(ec, &nbytes);
+  }
+  if (payload == NULL) return -1;
+  if (dst_size < PWDC_SELECT_HEADER_BYTES + (size_t)nbytes) return -1;
+  dst[0] = (unsigned char)coder;
+  memcpy(dst + PWDC_SELECT_HEADER_BYTES, payload, nbytes);
+  return PWDC_SELECT_HEADER_BYTES + (int64_t)nbytes;
+}
+
+int pwdc_select_read_header(const unsigned char *buf, size_t size,
+                            pwdc_coder *coder) {
+  if (buf == NULL || size < PWDC_SELECT_HEADER_BYTES || buf[0] > 1) return -1;
+  *coder = (pwdc_coder)buf[0];
+  return PWDC_SELECT_HEADER_BYTES;
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef AOM_AOM_DSP_PWDC_SELECT_H_
+#define AOM_AOM_DSP_PWDC_SELECT_H_
+
+#include <stddef.h>
+
+#include "aom_dsp/pwdc_huff.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*Per-tile coder selection (Phase 3).
+  The tile's symbols are buffered as for pwdc_huff.h. Before any coding, the
+   size of both coders is estimated: the range coder from the probabilities
+   captured with each symbol (a shadow of its arithmetic, at the 9-bit
+   precision it actually uses), the prefix coder exactly from its code
+   lengths. The prefix coder is used when it costs at most the gate more.
+  The chosen coder is signalled in a one-byte header ahead of the payload:
+   bit 0 is the coder, the other bits are reserved and zero.*/
+
+typedef enum {
+  PWDC_CODER_RANGE = 0,
+  PWDC_CODER_HUFF = 1,
+} pwdc_coder;
+
+/*The default gate: 1%, in basis points.*/
+#define PWDC_SELECT_THRESHOLD_BP (100)
+/*The extra overhead each speed step accepts, in basis points.*/
+#define PWDC_SELECT_SPEED_STEP_BP (100)
+#define PWDC_SELECT_MAX_SPEED (8)
+
+#define PWDC_SELECT_HEADER_BYTES (1)
+
+typedef struct {
+  /*How much larger than the range coder output, in basis points, the prefix
+     coder output may be and still be chosen. Negative values disable it.*/
+  int threshold_bp;
+  /*0 to PWDC_SELECT_MAX_SPEED. Each step trades another
+     PWDC_SELECT_SPEED_STEP_BP of size for the table-lookup decoder.*/
+  int speed;
+} pwdc_select_config;
+
+typedef struct {
+  pwdc_coder coder;
+  /*Estimated range coder size and exact prefix coder size, in bits.*/
+  int64_t range_bits;
+  int64_t huff_bits;
+} pwdc_select_report;
+
+void pwdc_select_config_init(pwdc_select_config *cfg) OD_ARG_NONNULL(1);
+
+/*The shadow estimate of the range coder output for the buffered symbols, in
+   bits.*/
+OD_WARN_UNUSED_RESULT int64_t pwdc_select_range_cost(const od_ec_symbuf *sb)
+    OD_ARG_NONNULL(1);
+
+/*Applies the gate to a pair of sizes.*/
+OD_WARN_UNUSED_RESULT pwdc_coder pwdc_select_decide(
+    const pwdc_select_config *cfg, int64_t range_bits, int64_t huff_bits)
+    OD_ARG_NONNULL(1);
+
+/*Detaches sb (attached with pwdc_huff_begin()), picks a coder and codes the
+   symbols with it, into ec or henc. report may be NULL.
+  Returns the coder used, or -1 on failure.*/
+int pwdc_select_encode(od_ec_symbuf *sb, od_ec_enc *ec, pwdc_huff_enc *henc,
+                       const pwdc_select_config *cfg,
+                       pwdc_select_report *report) OD_ARG_NONNULL(1)
+    OD_ARG_NONNULL(2) OD_ARG_NONNULL(3) OD_ARG_NONNULL(4);
+
+/*Finishes the chosen coder and writes the header and payload to dst.
+  Returns the number of bytes written, or -1 if dst_size is too small or the
+   coder failed.*/
+int64_t pwdc_select_write(unsigned char *dst, size_t dst_size,
+                          pwdc_coder coder, od_ec_enc *ec,
+                          pwdc_huff_enc *henc) OD_ARG_NONNULL(1)
+    OD_ARG_NONNULL(4) OD_ARG_NONNULL(5);
+
+/*Parses the header. Returns its size, or -1 if it is invalid.*/
+int pwdc_select_read_header(const unsigned char *buf, size_t size,
+                            pwdc_coder *coder) OD_ARG_NONNULL(3);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_AOM_DSP_PWDC_SELECT_H_
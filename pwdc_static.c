@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aom_dsp/pwdc_static.h"
+#include "aom_ports/aom_timer.h"
+
+typedef struct {
+  uint32_t count[16];
+  uint32_t total;
+  int nsyms;
+  int use_static;
+  /*Code length with the adaptive CDFs, in 1/256 bit.*/
+  int64_t adaptive_q8;
+  /*The static table, in units of 1/PWDC_STATIC_PROB_TOP, and as an icdf.*/
+  uint16_t freq[16];
+  uint16_t icdf[16];
+} pwdc_ctx_hist;
+
+/*Runs body with sym pointing at each buffered record, in coding order.*/
+#define PWDC_FOR_EACH_SYM(sb, sym, body)                                   \
+  do {                                                                     \
+    const od_ec_symbuf_block *blk_ = (sb)->head;                           \
+    for (uint32_t b_ = 0; blk_ != NULL && b_ <= (sb)->nblocks; b_++) {     \
+      const uint32_t n_ = b_ < (sb)->nblocks                               \
+                              ? OD_EC_SYMBUF_BLOCK_SIZE                    \
+                              : (uint32_t)((sb)->pos - blk_->syms);        \
+      for (uint32_t i_ = 0; i_ < n_; i_++) {                               \
+        const od_ec_sym *sym = &blk_->syms[i_];                            \
+        body;                                                              \
+      }                                                                    \
+      blk_ = blk_->next;                                                   \
+    }                                                                      \
+  } while (0)
+
+static int pwdc_eg0_bits(unsigned v) {
+  return 2 * (OD_ILOG_NZ(v + 1) - 1) + 1;
+}
+
+static void pwdc_write_eg0(od_ec_enc *enc, unsigned v) {
+  const int n = OD_ILOG_NZ(v + 1) - 1;
+  for (int i = 0; i < n; i++) od_ec_encode_bool_q15(enc, 0, 16384);
+  for (int i = n; i >= 0; i--) {
+    od_ec_encode_bool_q15(enc, ((v + 1) >> i) & 1, 16384);
+  }
+}
+
+/*Quantizes the histogram to PWDC_STATIC_PROB_TOP, keeping every symbol that
+   occurred codable. Returns the cost of the tile's symbols with the table,
+   in 1/256 bit, from the same cost table as the adaptive estimate.*/
+static int64_t pwdc_build_table(pwdc_ctx_hist *h, const uint16_t *cost) {
+  int sum = 0;
+  int top = 0;
+  for (int i = 0; i < h->nsyms; i++) {
+    const uint32_t c = h->count[i];
+    h->freq[i] = c == 0 ? 0
+                        : (uint16_t)OD_MAXI(
+                              1, (int)(((uint64_t)c * PWDC_STATIC_PROB_TOP +
+                                        h->total / 2) /
+                                       h->total));
+    sum += h->freq[i];
+    if (h->freq[i] > h->freq[top]) top = i;
+  }
+  /*Rounding error is absorbed by the most likely symbols, where it costs the
+     least.*/
+  while (sum > PWDC_STATIC_PROB_TOP) {
+    int big = 0;
+    for (int i = 1; i < h->nsyms; i++) {
+      if (h->freq[i] > h->freq[big]) big = i;
+    }
+    h->freq[big]--;
+    sum--;
+  }
+  h->freq[top] += (uint16_t)(PWDC_STATIC_PROB_TOP - sum);
+  int64_t bits_q8 = 0;
+  int cum = 0;
+  for (int i = 0; i < h->nsyms; i++) {
+    cum += h->freq[i];
+    h->icdf[i] = (uint16_t)OD_ICDF(cum << EC_PROB_SHIFT);
+    bits_q8 += (int64_t)h->count[i] * cost[h->freq[i]];
+  }
+  assert(h->icdf[h->nsyms - 1] == 0);
+  return bits_q8;
+}
+
+int pwdc_static_begin(od_ec_symbuf *sb, od_ec_enc *enc) {
+  if (od_ec_symbuf_track_contexts(sb)) return -1;
+  od_ec_symbuf_reset(sb);
+  enc->symbuf = sb;
+  return 0;
+}
+
+int pwdc_static_encode(od_ec_symbuf *sb, od_ec_enc *enc,
+                       pwdc_static_report *report) {
+  struct aom_usec_timer timer;
+  const uint32_t num_ctx = sb->num_ctx;
+  int table_bits = 0;
+  int static_contexts = 0;
+  uint16_t cost[OD_EC_COST_PROB_TOP + 1];
+  /*The cost of every symbol with the probabilities it was captured with.*/
+  int64_t adaptive_q8 = 0;
+  enc->symbuf = NULL;
+  if (sb->error) return -1;
+  pwdc_ctx_hist *hist = (pwdc_ctx_hist *)calloc(num_ctx + 1, sizeof(*hist));
+  if (hist == NULL) return -1;
+
+  aom_usec_timer_start(&timer);
+  od_ec_cost_init(cost);
+  PWDC_FOR_EACH_SYM(sb, sym, {
+    const uint32_t sym_q8 = od_ec_sym_cost_q8(cost, sym);
+    if (sym->ctx != 0) {
+      pwdc_ctx_hist *h = &hist[sym->ctx];
+      assert(sym->nsyms <= 16);
+      h->count[sym->s]++;
+      h->total++;
+      h->nsyms = sym->nsyms;
+      h->adaptive_q8 += sym_q8;
+    }
+    adaptive_q8 += sym_q8;
+  });
+  for (uint32_t c = 1; c <= num_ctx; c++) {
+    pwdc_ctx_hist *h = &hist[c];
+    int desc_bits = 1;
+    if (h->total == 0) continue;
+    const int64_t static_q8 = pwdc_build_table(h, cost);
+    for (int i = 0; i < h->nsyms - 1; i++) {
+      desc_bits += pwdc_eg0_bits(h->freq[i]);
+    }
+    h->use_static =
+        static_q8 + ((int64_t)(desc_bits - 1) << 8) < h->adaptive_q8;
+    table_bits += h->use_static ? desc_bits : 1;
+    static_contexts += h->use_static;
+  }
+
+  const int start = od_ec_enc_tell(enc);
+  for (uint32_t c = 1; c <= num_ctx; c++) {
+    const pwdc_ctx_hist *h = &hist[c];
+    od_ec_encode_bool_q15(enc, h->use_static, 16384);
+    if (!h->use_static) continue;
+    for (int i = 0; i < h->nsyms - 1; i++) pwdc_write_eg0(enc, h->freq[i]);
+  }
+  PWDC_FOR_EACH_SYM(sb, sym, {
+    const pwdc_ctx_hist *h = &hist[sym->ctx];
+    if (sym->ctx != 0 && h->use_static) {
+      od_ec_encode_cdf_q15(enc, sym->s, h->icdf, h->nsyms);
+    } else {
+      od_ec_encode_syms(enc, sym, 1, sb->ctx_stats);
+    }
+  });
+  aom_usec_timer_mark(&timer);
+
+  if (report != NULL) {
+    report->num_symbols = od_ec_symbuf_count(sb);
+    report->num_contexts = num_ctx;
+    report->static_contexts = static_contexts;
+    report->table_bits = table_bits;
+    report->static_bytes = (od_ec_enc_tell(enc) - start + 7) >> 3;
+    report->encode_usec = aom_usec_timer_elapsed(&timer);
+    /*Estimated rather than coded: draining sb into a second encoder would
+       count every symbol into this thread's PWDC statistics again. This is
+       the estimate pwdc_select_range_cost() makes.*/
+    report->adaptive_bytes =
+        (uint32_t)((od_ec_cost_bits(adaptive_q8) + 7) >> 3);
+  }
+  free(hist);
+  return enc->error ? -1 : 0;
+}
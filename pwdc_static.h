@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef AOM_AOM_DSP_PWDC_STATIC_H_
+#define AOM_AOM_DSP_PWDC_STATIC_H_
+
+#include "aom_dsp/entenc_pipe.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*PWDC symbol accumulation: two-pass coding with static per-context tables.
+  Pass 1 buffers every symbol of a tile together with its context (the CDF it
+   was written with). Pass 2 builds a histogram per context and, where a
+   static table plus its description is cheaper than the adaptive CDF, codes
+   that context's symbols with the static table. Other contexts, and all
+   bools, keep the probabilities the adaptive coder would have used.
+  The output starts with the table descriptions, in order of first context
+   use: a flag per context, then for static contexts nsyms - 1 frequencies
+   in units of 1/PWDC_STATIC_PROB_TOP, Exp-Golomb coded with raw bools.*/
+
+/*Table precision. The range coder only uses the top 9 bits of each Q15
+   probability (see EC_PROB_SHIFT), so finer tables would be wasted.*/
+#define PWDC_STATIC_PROB_BITS (15 - EC_PROB_SHIFT)
+#define PWDC_STATIC_PROB_TOP (1 << PWDC_STATIC_PROB_BITS)
+
+typedef struct {
+  uint32_t num_symbols;
+  /*Contexts seen, and how many of them were coded with a static table.*/
+  uint32_t num_contexts;
+  uint32_t static_contexts;
+  /*Bits spent on table descriptions, including the per-context flags.*/
+  uint32_t table_bits;
+  /*Size of the tile coded with the adaptive CDFs (the normal path), and with
+     the static tables, in bytes. The adaptive size is estimated from the
+     probabilities captured with each symbol with od_ec_sym_cost_q8(), as
+     pwdc_select_range_cost() does, so the report adds nothing to the
+     thread's PWDC statistics.*/
+  uint32_t adaptive_bytes;
+  uint32_t static_bytes;
+  /*Time spent in the second pass, in microseconds.*/
+  int64_t encode_usec;
+} pwdc_static_report;
+
+/*Starts pass 1: resets sb, turns on context tracking and attaches it to enc,
+   so the aom_writer wrapping enc buffers its symbols. Returns 0 on success.*/
+int pwdc_static_begin(od_ec_symbuf *sb, od_ec_enc *enc) OD_ARG_NONNULL(1)
+    OD_ARG_NONNULL(2);
+
+/*Runs pass 2: detaches sb and codes the tables and symbols into enc, which is
+   then ready for od_ec_enc_done(). report may be NULL.
+  Returns 0 on success.*/
+int pwdc_static_encode(od_ec_symbuf *sb, od_ec_enc *enc,
+                       pwdc_static_report *report) OD_ARG_NONNULL(1)
+    OD_ARG_NONNULL(2);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_AOM_DSP_PWDC_STATIC_H_
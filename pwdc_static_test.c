@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+/*pwdc_static_test: round trips of two-pass static-table coding (see
+   pwdc_static.h) through od_ec_dec.
+  Usage: pwdc_static_test [num_symbols]
+  Writes num_symbols adaptive symbols (default 30000) over 4- and 16-ary
+   contexts, with raw bits mixed in, at several skews, and codes them with
+   pwdc_static_encode(). The stream is then read back: the table
+   descriptions in order of first context use, then every symbol, with the
+   static table where the context has one and the adapted CDF otherwise.
+  Also checks that the report's adaptive size is the estimate of
+   pwdc_select_range_cost(), so the report and the 1% gate agree.*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aom_dsp/bitwriter.h"
+#include "aom_dsp/entdec.h"
+#include "aom_dsp/pwdc_select.h"
+#include "aom_dsp/pwdc_static.h"
+
+#define PWDC_STATIC_TEST_CONTEXTS (50)
+
+typedef struct {
+  uint8_t ctx;
+  uint8_t s;
+  /*A raw bit written before the symbol, or -1.*/
+  int8_t bit;
+} pwdc_static_test_sym;
+
+static uint32_t pwdc_static_test_rand(uint32_t *seed) {
+  *seed = *seed * 1103515245 + 12345;
+  return *seed >> 8;
+}
+
+static int pwdc_static_test_nsyms(int c) { return c % 2 ? 16 : 4; }
+
+static void pwdc_static_test_init_cdfs(aom_cdf_prob (*cdfs)[CDF_SIZE(16)]) {
+  memset(cdfs, 0, PWDC_STATIC_TEST_CONTEXTS * sizeof(*cdfs));
+  for (int c = 0; c < PWDC_STATIC_TEST_CONTEXTS; c++) {
+    const int n = pwdc_static_test_nsyms(c);
+    for (int i = 0; i < n - 1; i++) {
+      cdfs[c][i] = AOM_ICDF((i + 1) * CDF_PROB_TOP / n);
+    }
+  }
+}
+
+/*Reads a value written by pwdc_write_eg0().*/
+static unsigned pwdc_static_test_read_eg0(od_ec_dec *dec) {
+  int n = 0;
+  unsigned v = 1;
+  while (!od_ec_decode_bool_q15(dec, 16384)) n++;
+  for (int i = 0; i < n; i++) v = v << 1 | od_ec_decode_bool_q15(dec, 16384);
+  return v - 1;
+}
+
+static int pwdc_static_test_round_trip(uint32_t n, int skew) {
+  aom_cdf_prob(*cdfs)[CDF_SIZE(16)] = (aom_cdf_prob(*)[CDF_SIZE(16)])malloc(
+      PWDC_STATIC_TEST_CONTEXTS * sizeof(*cdfs));
+  pwdc_static_test_sym *syms =
+      (pwdc_static_test_sym *)malloc(n * sizeof(*syms));
+  /*Contexts in order of first use, from 1, and the static table of each
+     context, if it has one.*/
+  int order[PWDC_STATIC_TEST_CONTEXTS + 1];
+  int num_ctx = 0;
+  int seen[PWDC_STATIC_TEST_CONTEXTS] = { 0 };
+  int use_static[PWDC_STATIC_TEST_CONTEXTS] = { 0 };
+  uint16_t icdfs[PWDC_STATIC_TEST_CONTEXTS][16];
+  aom_writer w;
+  od_ec_symbuf sb;
+  od_ec_dec dec;
+  pwdc_static_report report;
+  uint32_t seed = 5 + skew;
+  uint32_t nbytes;
+  int ret = -1;
+  memset(&w, 0, sizeof(w));
+  od_ec_enc_init(&w.ec, 1024);
+  w.allow_update_cdf = 1;
+  od_ec_symbuf_init(&sb);
+  if (cdfs == NULL || syms == NULL) goto done;
+
+  pwdc_static_test_init_cdfs(cdfs);
+  if (pwdc_static_begin(&sb, &w.ec)) goto done;
+  for (uint32_t i = 0; i < n; i++) {
+    pwdc_static_test_sym *sym = &syms[i];
+    const int c =
+        (int)(pwdc_static_test_rand(&seed) % PWDC_STATIC_TEST_CONTEXTS);
+    const int nsyms = pwdc_static_test_nsyms(c);
+    int s = 0;
+    while (s < nsyms - 1 &&
+           pwdc_static_test_rand(&seed) % (skew + c % 3) == 0) {
+      s++;
+    }
+    sym->ctx = (uint8_t)c;
+    sym->s = (uint8_t)s;
+    sym->bit = pwdc_static_test_rand(&seed) % 10 == 0
+                   ? (int8_t)(pwdc_static_test_rand(&seed) & 1)
+                   : -1;
+    if (sym->bit >= 0) aom_write_bit(&w, sym->bit);
+    aom_write_symbol(&w, s, cdfs[c], nsyms);
+    if (!seen[c]) {
+      seen[c] = 1;
+      order[++num_ctx] = c;
+    }
+  }
+  if (pwdc_static_encode(&sb, &w.ec, &report)) goto done;
+  const unsigned char *buf = od_ec_enc_done(&w.ec, &nbytes);
+  if (buf == NULL) goto done;
+
+  if (report.num_contexts != (uint32_t)num_ctx) {
+    fprintf(stderr, "skew %d: %u contexts reported, %d used\n", skew,
+            report.num_contexts, num_ctx);
+    goto done;
+  }
+  const int64_t range_bits = pwdc_select_range_cost(&sb);
+  if (report.adaptive_bytes != (uint32_t)((range_bits + 7) >> 3)) {
+    fprintf(stderr, "skew %d: adaptive size %u bytes, the gate estimates %u\n",
+            skew, report.adaptive_bytes, (uint32_t)((range_bits + 7) >> 3));
+    goto done;
+  }
+
+  pwdc_static_test_init_cdfs(cdfs);
+  od_ec_dec_init(&dec, buf, nbytes);
+  for (int k = 1; k <= num_ctx; k++) {
+    const int c = order[k];
+    const int nsyms = pwdc_static_test_nsyms(c);
+    int cum = 0;
+    use_static[c] = od_ec_decode_bool_q15(&dec, 16384);
+    if (!use_static[c]) continue;
+    for (int i = 0; i < nsyms - 1; i++) {
+      cum += (int)pwdc_static_test_read_eg0(&dec);
+      if (cum > PWDC_STATIC_PROB_TOP) {
+        fprintf(stderr, "skew %d: context %d table overflows\n", skew, c);
+        goto done;
+      }
+      icdfs[c][i] = (uint16_t)OD_ICDF(cum << EC_PROB_SHIFT);
+    }
+    icdfs[c][nsyms - 1] = 0;
+  }
+  for (uint32_t i = 0; i < n; i++) {
+    const pwdc_static_test_sym *sym = &syms[i];
+    const int c = sym->ctx;
+    const int nsyms = pwdc_static_test_nsyms(c);
+    if (sym->bit >= 0 && od_ec_decode_bool_q15(&dec, 16384) != sym->bit) {
+      fprintf(stderr, "skew %d: bit %u mismatch\n", skew, i);
+      goto done;
+    }
+    const int s = od_ec_decode_cdf_q15(
+        &dec, use_static[c] ? icdfs[c] : cdfs[c], nsyms);
+    if (s != sym->s) {
+      fprintf(stderr, "skew %d: symbol %u mismatch\n", skew, i);
+      goto done;
+    }
+    /*The writer adapted every CDF while buffering, static or not.*/
+    update_cdf(cdfs[c], (int8_t)s, nsyms);
+  }
+  printf("skew %d: %u/%u static contexts, %u bytes against %u adaptive\n",
+         skew, report.static_contexts, report.num_contexts, nbytes,
+         report.adaptive_bytes);
+  ret = 0;
+done:
+  od_ec_symbuf_clear(&sb);
+  od_ec_enc_clear(&w.ec);
+  free(syms);
+  free(cdfs);
+  return ret;
+}
+
+int main(int argc, char **argv) {
+  const long n = argc > 1 ? strtol(argv[1], NULL, 0) : 30000;
+  if (n < 1 || n > (1 << 28)) {
+    fprintf(stderr, "Usage: %s [num_symbols]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  /*From nearly flat contexts, some of which keep the adaptive CDFs at the
+     default size, to heavily skewed ones, which all get static tables.*/
+  for (int skew = 2; skew <= 32; skew *= 2) {
+    if (pwdc_static_test_round_trip((uint32_t)n, skew)) return EXIT_FAILURE;
+  }
+  printf("pwdc_static_test: OK\n");
+  return EXIT_SUCCESS;
+}
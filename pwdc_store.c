@@ -0,0 +1,339 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#if !defined(_WIN32) && !defined(_FILE_OFFSET_BITS)
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "aom_dsp/pwdc_store.h"
+#include "aom_util/endian_inl.h"
+
+#if defined(_WIN32)
+#include <io.h>
+#define pwdc_store_fseek _fseeki64
+#define pwdc_store_ftell _ftelli64
+#define pwdc_store_truncate(f, size) _chsize_s(_fileno(f), (__int64)(size))
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define pwdc_store_fseek fseeko
+#define pwdc_store_ftell ftello
+#define pwdc_store_truncate(f, size) ftruncate(fileno(f), (off_t)(size))
+#endif
+
+#define PWDC_STORE_HEADER_BYTES (16)
+#define PWDC_STORE_BLOCK_HEADER_BYTES (16)
+#define PWDC_STORE_TRAILER_BYTES (24)
+
+static const char PWDC_STORE_MAGIC[8] = { 'P', 'W', 'D', 'C',
+                                          'S', 'T', 'R', '1' };
+static const char PWDC_STORE_INDEX_MAGIC[8] = { 'P', 'W', 'D', 'C',
+                                                'I', 'D', 'X', '1' };
+#define PWDC_STORE_BLOCK_MAGIC (0x4B425750U) /*"PWBK"*/
+
+static uint64_t pwdc_store_block_bytes(uint32_t num_frames) {
+  return PWDC_STORE_BLOCK_HEADER_BYTES +
+         (uint64_t)PWDC_STORE_COLS * num_frames * sizeof(uint64_t);
+}
+
+void pwdc_store_record_init(pwdc_store_record *rec, const pwdc_stats *stats,
+                            uint64_t encode_id, uint64_t frame) {
+  rec->encode_id = encode_id;
+  rec->frame = frame;
+  rec->total_symbols = stats->total_symbols;
+  rec->bytes = stats->total_bits_arith >> 3;
+  memcpy(rec->bool_count, stats->bool_count, sizeof(rec->bool_count));
+  memcpy(rec->channel_hits, stats->channel_hits, sizeof(rec->channel_hits));
+}
+
+static int pwdc_store_write(FILE *f, const void *data, size_t size) {
+  return fwrite(data, 1, size, f) == size ? 0 : -1;
+}
+
+static int pwdc_store_read(FILE *f, uint64_t offset, void *data, size_t size) {
+  if (pwdc_store_fseek(f, offset, SEEK_SET)) return -1;
+  return fread(data, 1, size, f) == size ? 0 : -1;
+}
+
+static int pwdc_store_add_block(pwdc_store_writer *w,
+                                const pwdc_store_block *blk) {
+  if (w->num_blocks == w->index_alloc) {
+    const uint32_t alloc = w->index_alloc ? 2 * w->index_alloc : 64;
+    pwdc_store_block *index = (pwdc_store_block *)realloc(
+        w->index, sizeof(*index) * alloc);
+    if (index == NULL) return -1;
+    w->index = index;
+    w->index_alloc = alloc;
+  }
+  w->index[w->num_blocks++] = *blk;
+  return 0;
+}
+
+/*Returns the range of column 0 over the n values at offset.*/
+static int pwdc_store_scan_ids(FILE *f, uint64_t offset, uint32_t n,
+                               pwdc_store_block *blk) {
+  uint64_t buf[256];
+  blk->encode_min = UINT64_MAX;
+  blk->encode_max = 0;
+  for (uint32_t i = 0; i < n;) {
+    const uint32_t k = OD_MINI(n - i, 256);
+    if (pwdc_store_read(f, offset + 8 * (uint64_t)i, buf, 8 * k)) return -1;
+    for (uint32_t j = 0; j < k; j++) {
+      const uint64_t id = HToLE64(buf[j]);
+      blk->encode_min = id < blk->encode_min ? id : blk->encode_min;
+      blk->encode_max = id > blk->encode_max ? id : blk->encode_max;
+    }
+    i += k;
+  }
+  return 0;
+}
+
+/*Reads the footer of an existing store, or rebuilds the index by walking the
+   blocks when the footer is missing or damaged.*/
+static int pwdc_store_load_index(pwdc_store_writer *w, uint64_t size) {
+  unsigned char trailer[PWDC_STORE_TRAILER_BYTES];
+  if (size >= PWDC_STORE_HEADER_BYTES + PWDC_STORE_TRAILER_BYTES &&
+      !pwdc_store_read(w->f, size - PWDC_STORE_TRAILER_BYTES, trailer,
+                       sizeof(trailer)) &&
+      !memcmp(trailer + 16, PWDC_STORE_INDEX_MAGIC, 8)) {
+    uint64_t index_offset;
+    uint32_t num_blocks;
+    memcpy(&index_offset, trailer, 8);
+    memcpy(&num_blocks, trailer + 8, 4);
+    index_offset = HToLE64(index_offset);
+    num_blocks = HToLE32(num_blocks);
+    if (index_offset >= PWDC_STORE_HEADER_BYTES &&
+        index_offset + (uint64_t)num_blocks * sizeof(pwdc_store_block) +
+                PWDC_STORE_TRAILER_BYTES ==
+            size) {
+      for (uint32_t b = 0; b < num_blocks; b++) {
+        pwdc_store_block blk;
+        if (pwdc_store_read(w->f, index_offset + b * sizeof(blk), &blk,
+                            sizeof(blk))) {
+          return -1;
+        }
+        blk.offset = HToLE64(blk.offset);
+        blk.num_frames = HToLE32(blk.num_frames);
+        blk.encode_min = HToLE64(blk.encode_min);
+        blk.encode_max = HToLE64(blk.encode_max);
+        if (pwdc_store_add_block(w, &blk)) return -1;
+      }
+      w->data_end = index_offset;
+      return 0;
+    }
+  }
+  /*No usable footer: keep every complete block.*/
+  uint64_t offset = PWDC_STORE_HEADER_BYTES;
+  for (;;) {
+    uint32_t hdr[2];
+    pwdc_store_block blk;
+    if (offset + PWDC_STORE_BLOCK_HEADER_BYTES > size ||
+        pwdc_store_read(w->f, offset, hdr, sizeof(hdr)) ||
+        HToLE32(hdr[0]) != PWDC_STORE_BLOCK_MAGIC) {
+      break;
+    }
+    blk.offset = offset;
+    blk.num_frames = HToLE32(hdr[1]);
+    blk.reserved = 0;
+    if (blk.num_frames == 0 ||
+        offset + pwdc_store_block_bytes(blk.num_frames) > size ||
+        pwdc_store_scan_ids(w->f, offset + PWDC_STORE_BLOCK_HEADER_BYTES,
+                            blk.num_frames, &blk) ||
+        pwdc_store_add_block(w, &blk)) {
+      break;
+    }
+    offset += pwdc_store_block_bytes(blk.num_frames);
+  }
+  w->data_end = offset;
+  fflush(w->f);
+  return pwdc_store_truncate(w->f, offset) ? -1 : 0;
+}
+
+int pwdc_store_open(pwdc_store_writer *w, const char *path) {
+  unsigned char header[PWDC_STORE_HEADER_BYTES];
+  uint32_t v;
+  memset(w, 0, sizeof(*w));
+  w->cols = (uint64_t *)malloc(sizeof(*w->cols) * PWDC_STORE_COLS *
+                               PWDC_STORE_BLOCK_FRAMES);
+  if (w->cols == NULL) goto fail;
+  w->f = fopen(path, "r+b");
+  if (w->f == NULL) {
+    w->f = fopen(path, "w+b");
+    if (w->f == NULL) goto fail;
+    memcpy(header, PWDC_STORE_MAGIC, 8);
+    v = HToLE32(PWDC_STORE_VERSION);
+    memcpy(header + 8, &v, 4);
+    v = HToLE32(PWDC_STORE_COLS);
+    memcpy(header + 12, &v, 4);
+    w->data_end = PWDC_STORE_HEADER_BYTES;
+    if (pwdc_store_write(w->f, header, sizeof(header)) ||
+        pwdc_store_flush(w)) {
+      goto fail;
+    }
+    return 0;
+  }
+  /*Never write to a file that is not a store.*/
+  if (pwdc_store_read(w->f, 0, header, sizeof(header)) ||
+      memcmp(header, PWDC_STORE_MAGIC, 8)) {
+    goto fail;
+  }
+  memcpy(&v, header + 12, 4);
+  if (HToLE32(v) != PWDC_STORE_COLS || pwdc_store_fseek(w->f, 0, SEEK_END) ||
+      pwdc_store_load_index(w, (uint64_t)pwdc_store_ftell(w->f))) {
+    goto fail;
+  }
+  return 0;
+fail:
+  w->error = -1;
+  pwdc_store_close(w);
+  return -1;
+}
+
+int pwdc_store_append(pwdc_store_writer *w, const pwdc_store_record *rec) {
+  const uint64_t *v = (const uint64_t *)rec;
+  if (w->error) return -1;
+  for (int c = 0; c < PWDC_STORE_COLS; c++) {
+    w->cols[(size_t)c * PWDC_STORE_BLOCK_FRAMES + w->num_pending] = v[c];
+  }
+  if (++w->num_pending == PWDC_STORE_BLOCK_FRAMES) return pwdc_store_flush(w);
+  return 0;
+}
+
+int pwdc_store_flush(pwdc_store_writer *w) {
+  const uint32_t n = w->num_pending;
+  if (w->error || w->f == NULL) return -1;
+  if (pwdc_store_fseek(w->f, w->data_end, SEEK_SET)) goto fail;
+  if (n > 0) {
+    pwdc_store_block blk;
+    const uint32_t hdr[4] = { HToLE32(PWDC_STORE_BLOCK_MAGIC), HToLE32(n), 0,
+                              0 };
+    blk.offset = w->data_end;
+    blk.num_frames = n;
+    blk.reserved = 0;
+    blk.encode_min = UINT64_MAX;
+    blk.encode_max = 0;
+    for (uint32_t i = 0; i < n; i++) {
+      const uint64_t id = w->cols[i];
+      blk.encode_min = id < blk.encode_min ? id : blk.encode_min;
+      blk.encode_max = id > blk.encode_max ? id : blk.encode_max;
+    }
+    if (pwdc_store_write(w->f, hdr, sizeof(hdr))) goto fail;
+    for (int c = 0; c < PWDC_STORE_COLS; c++) {
+      uint64_t *col = w->cols + (size_t)c * PWDC_STORE_BLOCK_FRAMES;
+      for (uint32_t i = 0; i < n; i++) col[i] = HToLE64(col[i]);
+      if (pwdc_store_write(w->f, col, sizeof(*col) * n)) goto fail;
+    }
+    if (pwdc_store_add_block(w, &blk)) goto fail;
+    w->data_end += pwdc_store_block_bytes(n);
+    w->num_pending = 0;
+  }
+  for (uint32_t b = 0; b < w->num_blocks; b++) {
+    pwdc_store_block blk = w->index[b];
+    blk.offset = HToLE64(blk.offset);
+    blk.num_frames = HToLE32(blk.num_frames);
+    blk.encode_min = HToLE64(blk.encode_min);
+    blk.encode_max = HToLE64(blk.encode_max);
+    if (pwdc_store_write(w->f, &blk, sizeof(blk))) goto fail;
+  }
+  {
+    unsigned char trailer[PWDC_STORE_TRAILER_BYTES] = { 0 };
+    const uint64_t index_offset = HToLE64(w->data_end);
+    const uint32_t num_blocks = HToLE32(w->num_blocks);
+    memcpy(trailer, &index_offset, 8);
+    memcpy(trailer + 8, &num_blocks, 4);
+    memcpy(trailer + 16, PWDC_STORE_INDEX_MAGIC, 8);
+    if (pwdc_store_write(w->f, trailer, sizeof(trailer)) || fflush(w->f)) {
+      goto fail;
+    }
+  }
+  return 0;
+fail:
+  w->error = -1;
+  return -1;
+}
+
+int pwdc_store_close(pwdc_store_writer *w) {
+  int ret = w->error;
+  if (w->f != NULL) {
+    if (!w->error && pwdc_store_flush(w)) ret = -1;
+    if (fclose(w->f)) ret = -1;
+  }
+  free(w->index);
+  free(w->cols);
+  memset(w, 0, sizeof(*w));
+  return ret;
+}
+
+int pwdc_store_map_open(pwdc_store_map *m, const char *path) {
+  memset(m, 0, sizeof(*m));
+#if defined(_WIN32)
+  (void)path;
+  return -1;
+#else
+  struct stat st;
+  void *map;
+  uint64_t index_offset;
+  uint32_t num_blocks;
+  uint32_t cols;
+  /*Columns are used in place.*/
+  if (HToLE32(1) != 1) return -1;
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0) return -1;
+  if (fstat(fd, &st) || (uint64_t)st.st_size < PWDC_STORE_HEADER_BYTES +
+                                                    PWDC_STORE_TRAILER_BYTES) {
+    close(fd);
+    return -1;
+  }
+  map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) return -1;
+  m->base = map;
+  m->size = (size_t)st.st_size;
+  const unsigned char *base = (const unsigned char *)map;
+  const unsigned char *trailer = base + m->size - PWDC_STORE_TRAILER_BYTES;
+  memcpy(&cols, base + 12, 4);
+  memcpy(&index_offset, trailer, 8);
+  memcpy(&num_blocks, trailer + 8, 4);
+  if (memcmp(base, PWDC_STORE_MAGIC, 8) || cols != PWDC_STORE_COLS ||
+      memcmp(trailer + 16, PWDC_STORE_INDEX_MAGIC, 8) ||
+      index_offset % 8 != 0 || index_offset < PWDC_STORE_HEADER_BYTES ||
+      index_offset + (uint64_t)num_blocks * sizeof(pwdc_store_block) +
+              PWDC_STORE_TRAILER_BYTES !=
+          m->size) {
+    pwdc_store_map_close(m);
+    return -1;
+  }
+  m->index = (const pwdc_store_block *)(base + index_offset);
+  m->num_blocks = num_blocks;
+  for (uint32_t b = 0; b < num_blocks; b++) {
+    const pwdc_store_block *blk = &m->index[b];
+    if (blk->offset % 8 != 0 || blk->offset < PWDC_STORE_HEADER_BYTES ||
+        blk->offset + pwdc_store_block_bytes(blk->num_frames) > index_offset) {
+      pwdc_store_map_close(m);
+      return -1;
+    }
+    m->num_frames += blk->num_frames;
+  }
+  return 0;
+#endif
+}
+
+void pwdc_store_map_close(pwdc_store_map *m) {
+#if !defined(_WIN32)
+  if (m->base != NULL) munmap(m->base, m->size);
+#endif
+  memset(m, 0, sizeof(*m));
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef AOM_AOM_DSP_PWDC_STORE_H_
+#define AOM_AOM_DSP_PWDC_STORE_H_
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "aom_dsp/entenc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*Append-only, memory-mappable store of per-frame PWDC statistics.
+  File layout, all integers little-endian:
+   header: "PWDCSTR1", u32 version, u32 number of columns
+   blocks: u32 "PWBK", u32 frames n, u64 reserved, then every column as n
+    u64 values
+   footer: the index, one entry per block, then the trailer: u64 offset of
+    the index, u32 number of blocks, u32 reserved, "PWDCIDX1"
+  Frames are buffered into blocks of up to PWDC_STORE_BLOCK_FRAMES. Each
+   flush writes a block over the old footer and a new footer after it, so the
+   file is complete after every flush. A file whose footer was lost (say the
+   encoder crashed mid-flush) is repaired on the next open for append by
+   walking the blocks from the start.
+  Everything is 8-byte aligned, so a reader can map the file and sum a column
+   in place.*/
+
+/*One frame: the fixed record layout, and the column order on disk.*/
+typedef struct {
+  /*Caller supplied, e.g. a hash of the encode job.*/
+  uint64_t encode_id;
+  uint64_t frame;
+  uint64_t total_symbols;
+  /*Bytes written by the range coder.*/
+  uint64_t bytes;
+  uint64_t bool_count[2];
+  uint64_t channel_hits[128];
+} pwdc_store_record;
+
+#define PWDC_STORE_COLS ((int)(sizeof(pwdc_store_record) / sizeof(uint64_t)))
+#define PWDC_STORE_COL_ENCODE_ID (0)
+#define PWDC_STORE_COL_FRAME (1)
+#define PWDC_STORE_COL_TOTAL_SYMBOLS (2)
+#define PWDC_STORE_COL_BYTES (3)
+#define PWDC_STORE_COL_BOOL_COUNT (4)
+#define PWDC_STORE_COL_CHANNEL_HITS (6)
+
+#define PWDC_STORE_VERSION (1)
+#define PWDC_STORE_BLOCK_FRAMES (4096)
+
+/*An index entry. encode_min/encode_max let queries for one encode skip
+   blocks.*/
+typedef struct {
+  uint64_t offset;
+  uint32_t num_frames;
+  uint32_t reserved;
+  uint64_t encode_min;
+  uint64_t encode_max;
+} pwdc_store_block;
+
+typedef struct {
+  FILE *f;
+  /*Where the next block goes: the start of the footer.*/
+  uint64_t data_end;
+  pwdc_store_block *index;
+  uint32_t num_blocks;
+  uint32_t index_alloc;
+  /*The pending block, column by column.*/
+  uint64_t *cols;
+  uint32_t num_pending;
+  int error;
+} pwdc_store_writer;
+
+/*Fills a record from a thread's statistics (see pwdc_stats_get()).*/
+void pwdc_store_record_init(pwdc_store_record *rec, const pwdc_stats *stats,
+                            uint64_t encode_id, uint64_t frame)
+    OD_ARG_NONNULL(1) OD_ARG_NONNULL(2);
+
+/*Opens path for appending, creating it if needed. Returns 0 on success.*/
+int pwdc_store_open(pwdc_store_writer *w, const char *path) OD_ARG_NONNULL(1)
+    OD_ARG_NONNULL(2);
+int pwdc_store_append(pwdc_store_writer *w, const pwdc_store_record *rec)
+    OD_ARG_NONNULL(1) OD_ARG_NONNULL(2);
+/*Writes out the pending frames and the footer.*/
+int pwdc_store_flush(pwdc_store_writer *w) OD_ARG_NONNULL(1);
+/*Flushes and closes. Returns 0 if everything was written.*/
+int pwdc_store_close(pwdc_store_writer *w) OD_ARG_NONNULL(1);
+
+/*A read-only mapping of a store.*/
+typedef struct {
+  /*The mapping as mmap() returned it, for munmap(); read it through
+     pwdc_store_column().*/
+  void *base;
+  size_t size;
+  const pwdc_store_block *index;
+  uint32_t num_blocks;
+  uint64_t num_frames;
+} pwdc_store_map;
+
+/*Maps path and checks its footer. Returns 0 on success; fails on hosts that
+   are not little-endian, or without mmap().*/
+int pwdc_store_map_open(pwdc_store_map *m, const char *path)
+    OD_ARG_NONNULL(1) OD_ARG_NONNULL(2);
+void pwdc_store_map_close(pwdc_store_map *m) OD_ARG_NONNULL(1);
+
+/*Column col of block b, num_frames values, in place in the mapping.*/
+static inline const uint64_t *pwdc_store_column(const pwdc_store_map *m,
+                                                uint32_t b, int col) {
+  const pwdc_store_block *blk = &m->index[b];
+  const unsigned char *data = (const unsigned char *)m->base + blk->offset;
+  return (const uint64_t *)(data + 16) + (size_t)col * blk->num_frames;
+}
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_AOM_DSP_PWDC_STORE_H_
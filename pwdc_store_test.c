@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+/*pwdc_store_test: appends, footer repair and truncation of the per-frame
+   stats store (see pwdc_store.h).
+  Usage: pwdc_store_test [path]
+  Uses path (default pwdc_store_test.pwdc, removed afterwards) as the store.
+  - Frames appended over several blocks and flushes, then more appended
+     after reopening, must all read back through the mapping.
+  - With the footer cut off, or the file cut inside a block, reopening must
+     keep exactly the complete blocks, and appending must work again.
+  - A file that is not a store must be left alone, and a store whose
+     footer is damaged must not map.
+  POSIX only.*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "aom_dsp/pwdc_store.h"
+
+/*The frames in each block of a full flush.*/
+#define PWDC_STORE_TEST_BLOCK (PWDC_STORE_BLOCK_FRAMES)
+
+/*Deterministic contents for frame f of encode e.*/
+static void pwdc_store_test_record(pwdc_store_record *rec, uint64_t e,
+                                   uint64_t f) {
+  uint64_t *v = (uint64_t *)rec;
+  for (int c = 0; c < PWDC_STORE_COLS; c++) {
+    v[c] = (e * 1000003 + f) * 31 + (uint64_t)c;
+  }
+  rec->encode_id = e;
+  rec->frame = f;
+}
+
+/*Appends frames [from, to) of encode e, flushing every flush_every frames
+   if that is not 0.*/
+static int pwdc_store_test_append(pwdc_store_writer *w, uint64_t e,
+                                  uint64_t from, uint64_t to,
+                                  uint64_t flush_every) {
+  for (uint64_t f = from; f < to; f++) {
+    pwdc_store_record rec;
+    pwdc_store_test_record(&rec, e, f);
+    if (pwdc_store_append(w, &rec)) return -1;
+    if (flush_every && (f + 1) % flush_every == 0 && pwdc_store_flush(w)) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/*Maps path and checks that it holds frames [0, counts[e]) of each encode e
+   < num_encodes, in that order, and nothing else.*/
+static int pwdc_store_test_check(const char *path, const char *what,
+                                 const uint64_t *counts, int num_encodes) {
+  pwdc_store_map m;
+  uint64_t want = 0;
+  uint64_t seen = 0;
+  int e = 0;
+  uint64_t f = 0;
+  for (int i = 0; i < num_encodes; i++) want += counts[i];
+  if (pwdc_store_map_open(&m, path)) {
+    fprintf(stderr, "%s: the store does not map\n", what);
+    return -1;
+  }
+  if (m.num_frames != want) {
+    fprintf(stderr, "%s: %llu frames, expected %llu\n", what,
+            (unsigned long long)m.num_frames, (unsigned long long)want);
+    pwdc_store_map_close(&m);
+    return -1;
+  }
+  for (uint32_t b = 0; b < m.num_blocks; b++) {
+    const uint32_t n = m.index[b].num_frames;
+    for (uint32_t i = 0; i < n; i++, seen++) {
+      pwdc_store_record rec;
+      while (e < num_encodes && f == counts[e]) {
+        e++;
+        f = 0;
+      }
+      pwdc_store_test_record(&rec, (uint64_t)e, f++);
+      const uint64_t *v = (const uint64_t *)&rec;
+      for (int c = 0; c < PWDC_STORE_COLS; c++) {
+        if (pwdc_store_column(&m, b, c)[i] != v[c]) {
+          fprintf(stderr, "%s: frame %llu column %d differs\n", what,
+                  (unsigned long long)seen, c);
+          pwdc_store_map_close(&m);
+          return -1;
+        }
+      }
+      if (m.index[b].encode_min > rec.encode_id ||
+          m.index[b].encode_max < rec.encode_id) {
+        fprintf(stderr, "%s: block %u index range misses encode %d\n", what,
+                b, e);
+        pwdc_store_map_close(&m);
+        return -1;
+      }
+    }
+  }
+  pwdc_store_map_close(&m);
+  return 0;
+}
+
+static long pwdc_store_test_size(const char *path) {
+  FILE *f = fopen(path, "rb");
+  long size = -1;
+  if (f != NULL && !fseek(f, 0, SEEK_END)) size = ftell(f);
+  if (f != NULL) fclose(f);
+  return size;
+}
+
+/*Reopens the store, appends frames [counts[e], counts[e] + n) of encode e
+   and closes it.*/
+static int pwdc_store_test_reopen(const char *path, const char *what,
+                                  uint64_t *counts, int e, uint64_t n) {
+  pwdc_store_writer w;
+  if (pwdc_store_open(&w, path) ||
+      pwdc_store_test_append(&w, (uint64_t)e, counts[e], counts[e] + n, 0) ||
+      pwdc_store_close(&w)) {
+    fprintf(stderr, "%s: appending after reopening failed\n", what);
+    return -1;
+  }
+  counts[e] += n;
+  return 0;
+}
+
+static int pwdc_store_test_run(const char *path) {
+  /*Frames of encodes 0 to 3 that the store should hold.*/
+  uint64_t counts[4] = { 0 };
+  pwdc_store_writer w;
+  FILE *f;
+  unsigned char junk[64];
+  remove(path);
+
+  /*Two full blocks, flushed by append(), then small flushed blocks.*/
+  const uint64_t n0 = 2 * PWDC_STORE_TEST_BLOCK + 700;
+  if (pwdc_store_open(&w, path) ||
+      pwdc_store_test_append(&w, 0, 0, 2 * PWDC_STORE_TEST_BLOCK, 0) ||
+      pwdc_store_test_append(&w, 0, 2 * PWDC_STORE_TEST_BLOCK, n0, 300) ||
+      pwdc_store_close(&w)) {
+    fprintf(stderr, "append: writing failed\n");
+    return -1;
+  }
+  counts[0] = n0;
+  if (pwdc_store_test_check(path, "append", counts, 1)) return -1;
+  if (pwdc_store_test_reopen(path, "append", counts, 1, 5000) ||
+      pwdc_store_test_check(path, "reopened", counts, 2)) {
+    return -1;
+  }
+
+  /*The footer lost, as if the encoder died mid-flush: the blocks are all
+     complete, so every frame must survive.*/
+  const long size = pwdc_store_test_size(path);
+  pwdc_store_map m;
+  if (pwdc_store_map_open(&m, path)) return -1;
+  /*The footer is the index, then a 24-byte trailer.*/
+  const uint64_t footer =
+      (uint64_t)size - m.num_blocks * sizeof(*m.index) - 24;
+  const uint64_t last_block = m.index[m.num_blocks - 1].offset;
+  const uint32_t last_frames = m.index[m.num_blocks - 1].num_frames;
+  pwdc_store_map_close(&m);
+  if (truncate(path, (off_t)(footer + 10))) return -1;
+  if (pwdc_store_map_open(&m, path) == 0) {
+    pwdc_store_map_close(&m);
+    fprintf(stderr, "repair: a store without a footer mapped\n");
+    return -1;
+  }
+  if (pwdc_store_test_reopen(path, "repair", counts, 2, 10) ||
+      pwdc_store_test_check(path, "repair", counts, 3)) {
+    return -1;
+  }
+
+  /*Cut inside what is now the last-but-one block: it and the block after
+     it go, the ones before stay.*/
+  if (truncate(path, (off_t)(last_block + 16 + 8 * last_frames))) return -1;
+  counts[1] -= last_frames;
+  counts[2] = 0;
+  if (pwdc_store_test_reopen(path, "truncation", counts, 3, 1) ||
+      pwdc_store_test_check(path, "truncation", counts, 4)) {
+    return -1;
+  }
+
+  /*A damaged index magic: the writer rebuilds it, the reader refuses it.*/
+  f = fopen(path, "r+b");
+  if (f == NULL || fseek(f, -1, SEEK_END) || fputc('X', f) == EOF) {
+    if (f != NULL) fclose(f);
+    return -1;
+  }
+  fclose(f);
+  if (pwdc_store_map_open(&m, path) == 0) {
+    pwdc_store_map_close(&m);
+    fprintf(stderr, "damaged footer: the store mapped\n");
+    return -1;
+  }
+  if (pwdc_store_test_reopen(path, "damaged footer", counts, 3, 1) ||
+      pwdc_store_test_check(path, "damaged footer", counts, 4)) {
+    return -1;
+  }
+
+  /*Not a store: opening for append must fail and change nothing.*/
+  f = fopen(path, "wb");
+  if (f == NULL) return -1;
+  memset(junk, 'j', sizeof(junk));
+  fwrite(junk, 1, sizeof(junk), f);
+  fclose(f);
+  if (pwdc_store_open(&w, path) == 0) {
+    pwdc_store_close(&w);
+    fprintf(stderr, "not a store: opened for append\n");
+    return -1;
+  }
+  if (pwdc_store_test_size(path) != (long)sizeof(junk)) {
+    fprintf(stderr, "not a store: the file was changed\n");
+    return -1;
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  const char *path = argc > 1 ? argv[1] : "pwdc_store_test.pwdc";
+  const int ret = pwdc_store_test_run(path);
+  remove(path);
+  if (ret) return EXIT_FAILURE;
+  printf("pwdc_store_test: OK\n");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+/*pwdc_stream_test: streamed output (see od_ec_enc_set_stream() and
+   od_ec_enc_stream_pull()) against the buffer od_ec_enc_done() returns.
+  Usage: pwdc_stream_test
+  Codes random bools, bits and CDF symbols for several seeds, sizes and
+   minimum range sizes, into an encoder whose buffer starts small and grows.
+  - The ranges handed to the stream callback, copied as they arrive, must
+     add up to exactly the od_ec_enc_done() output. Every range but the one
+     od_ec_enc_done() hands over must be at least the minimum, and long
+     tiles must stream before od_ec_enc_done().
+  - The same for the bytes od_ec_enc_stream_pull() returns, followed by the
+     rest of the output.
+  - Streaming implies bounded-carry mode; turning that off must stop the
+     callbacks, od_ec_enc_done() included.*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aom_dsp/entenc.h"
+
+static const int pwdc_stream_test_sizes[] = { 0, 1, 5, 100, 3000, 200000 };
+static const uint32_t pwdc_stream_test_mins[] = { 1, 7, 256, 4096 };
+#define PWDC_STREAM_TEST_SEEDS (4)
+
+typedef struct {
+  unsigned char *buf;
+  uint32_t size;
+  uint32_t alloc;
+  uint32_t min_bytes;
+  uint32_t calls;
+  /*Ranges shorter than the minimum, and calls made by od_ec_enc_done().*/
+  uint32_t short_calls;
+  uint32_t done_calls;
+  int in_done;
+  int error;
+} pwdc_stream_test_sink;
+
+static uint32_t pwdc_stream_test_rand(uint32_t *seed) {
+  *seed = *seed * 1103515245 + 12345;
+  return *seed >> 8;
+}
+
+static void pwdc_stream_test_append(pwdc_stream_test_sink *sink,
+                                    const unsigned char *data,
+                                    uint32_t nbytes) {
+  if (nbytes == 0) return;
+  if (sink->size + nbytes > sink->alloc) {
+    const uint32_t alloc = 2 * (sink->size + nbytes);
+    unsigned char *buf = (unsigned char *)realloc(sink->buf, alloc);
+    if (buf == NULL) {
+      sink->error = 1;
+      return;
+    }
+    sink->buf = buf;
+    sink->alloc = alloc;
+  }
+  memcpy(sink->buf + sink->size, data, nbytes);
+  sink->size += nbytes;
+}
+
+static void pwdc_stream_test_fn(void *priv, const unsigned char *data,
+                                uint32_t nbytes) {
+  pwdc_stream_test_sink *sink = (pwdc_stream_test_sink *)priv;
+  sink->calls++;
+  if (sink->in_done) {
+    sink->done_calls++;
+  } else if (nbytes < sink->min_bytes) {
+    sink->short_calls++;
+  }
+  pwdc_stream_test_append(sink, data, nbytes);
+}
+
+static void pwdc_stream_test_code(od_ec_enc *enc, uint32_t seed, int n,
+                                  pwdc_stream_test_sink *pull) {
+  static const uint16_t icdf[8] = { 30000, 26000, 20000, 14000,
+                                    9000,  5000,  2000,  0 };
+  for (int i = 0; i < n; i++) {
+    const uint32_t r = pwdc_stream_test_rand(&seed);
+    switch (r % 4) {
+      case 0: {
+        unsigned f = 1 + (r >> 2) % 32767;
+        /*Near-certain bools make long runs of 0xFF bytes.*/
+        if ((r >> 17) % 4 == 0) f = 32767 - (r >> 19) % 8;
+        od_ec_encode_bool_q15(enc, (r >> 22) % 8 != 0, f);
+        break;
+      }
+      case 1: od_ec_encode_bool_half(enc, (r >> 2) & 1); break;
+      default: od_ec_encode_cdf_q15(enc, (int)((r >> 2) % 8), icdf, 8); break;
+    }
+    if (pull != NULL && i % 37 == 0) {
+      uint32_t nbytes;
+      const unsigned char *data = od_ec_enc_stream_pull(enc, &nbytes);
+      pwdc_stream_test_append(pull, data, nbytes);
+    }
+  }
+}
+
+/*Codes one case with the callback (pull == 0) or by pulling (pull == 1),
+   and checks what was streamed against the output.*/
+static int pwdc_stream_test_case(od_ec_enc *enc, uint32_t seed, int n,
+                                 uint32_t min_bytes, int pull) {
+  pwdc_stream_test_sink sink;
+  uint32_t nbytes;
+  int ret = -1;
+  memset(&sink, 0, sizeof(sink));
+  sink.min_bytes = min_bytes;
+  od_ec_enc_reset(enc);
+  if (pull) {
+    od_ec_enc_set_stream(enc, NULL, NULL, 0);
+    od_ec_enc_set_bounded_carry(enc, 1);
+  } else {
+    od_ec_enc_set_stream(enc, pwdc_stream_test_fn, &sink, min_bytes);
+  }
+  pwdc_stream_test_code(enc, seed, n, pull ? &sink : NULL);
+  const uint32_t streamed = sink.size;
+  const uint32_t early_calls = sink.calls;
+  sink.in_done = 1;
+  const unsigned char *out = od_ec_enc_done(enc, &nbytes);
+  if (out == NULL || sink.error) {
+    fprintf(stderr, "seed %u, %d symbols: coding failed\n", seed, n);
+    goto done;
+  }
+  /*Pulling leaves the tail after the last pull to be taken from the
+     output.*/
+  if (pull && streamed <= nbytes) {
+    pwdc_stream_test_append(&sink, out + streamed, nbytes - streamed);
+  }
+  if (sink.size != nbytes || memcmp(sink.buf, out, nbytes)) {
+    fprintf(stderr,
+            "seed %u, %d symbols, min %u%s: %u bytes streamed, %u output\n",
+            seed, n, min_bytes, pull ? ", pulled" : "", sink.size, nbytes);
+    goto done;
+  }
+  if (!pull) {
+    if (sink.short_calls > 0 || sink.done_calls > 1) {
+      fprintf(stderr,
+              "seed %u, %d symbols, min %u: %u short ranges, %u at the "
+              "end\n",
+              seed, n, min_bytes, sink.short_calls, sink.done_calls);
+      goto done;
+    }
+    if (nbytes > 4 * min_bytes + 64 && early_calls == 0) {
+      fprintf(stderr, "seed %u, %d symbols, min %u: nothing streamed early\n",
+              seed, n, min_bytes);
+      goto done;
+    }
+  } else if (n >= 100000 && streamed == 0) {
+    fprintf(stderr, "seed %u, %d symbols: nothing pulled early\n", seed, n);
+    goto done;
+  }
+  ret = 0;
+done:
+  free(sink.buf);
+  return ret;
+}
+
+/*Sets a stream callback, then turns bounded-carry mode off.*/
+static int pwdc_stream_test_unbounded(od_ec_enc *enc) {
+  pwdc_stream_test_sink sink;
+  uint32_t nbytes;
+  memset(&sink, 0, sizeof(sink));
+  od_ec_enc_reset(enc);
+  od_ec_enc_set_stream(enc, pwdc_stream_test_fn, &sink, 1);
+  od_ec_enc_set_bounded_carry(enc, 0);
+  pwdc_stream_test_code(enc, 3, 50000, NULL);
+  if (od_ec_enc_done(enc, &nbytes) == NULL || od_ec_enc_committed(enc) != 0 ||
+      sink.calls != 0) {
+    fprintf(stderr, "unbounded: %u stream calls\n", sink.calls);
+    free(sink.buf);
+    return -1;
+  }
+  free(sink.buf);
+  return 0;
+}
+
+int main(void) {
+  const int num_sizes =
+      (int)(sizeof(pwdc_stream_test_sizes) / sizeof(*pwdc_stream_test_sizes));
+  const int num_mins =
+      (int)(sizeof(pwdc_stream_test_mins) / sizeof(*pwdc_stream_test_mins));
+  od_ec_enc enc;
+  int ret = EXIT_FAILURE;
+  /*Start small so the output buffer grows while streaming.*/
+  od_ec_enc_init(&enc, 64);
+  for (uint32_t seed = 1; seed <= PWDC_STREAM_TEST_SEEDS; seed++) {
+    for (int k = 0; k < num_sizes; k++) {
+      const int n = pwdc_stream_test_sizes[k];
+      for (int m = 0; m < num_mins; m++) {
+        if (pwdc_stream_test_case(&enc, seed, n, pwdc_stream_test_mins[m],
+                                  0)) {
+          goto done;
+        }
+      }
+      if (pwdc_stream_test_case(&enc, seed, n, 1, 1)) goto done;
+    }
+  }
+  if (pwdc_stream_test_unbounded(&enc)) goto done;
+  printf("pwdc_stream_test: OK\n");
+  ret = EXIT_SUCCESS;
+done:
+  od_ec_enc_clear(&enc);
+  return ret;
+}
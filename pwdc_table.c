@@ -0,0 +1,437 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aom_dsp/pwdc_table.h"
+#include "aom_util/aom_thread.h"
+
+#if CONFIG_MULTITHREAD
+#include "aom_util/aom_pthread.h"
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PWDC_TABLE_NORM_SSE2 (1)
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define PWDC_TABLE_NORM_NEON (1)
+#endif
+
+/*Contexts handed to a worker at a time.*/
+#define PWDC_TABLE_CHUNK (32)
+/*Cache slots tried from a key's home slot, one of which a miss replaces.*/
+#define PWDC_TABLE_PROBES (8)
+
+typedef struct {
+  pwdc_table table;
+  int used;
+  /*Set when the build numbered epoch has claimed the slot for the table of
+     its context owner, which goes in once it is built.*/
+  uint32_t epoch;
+  uint32_t owner;
+  /*The last build that stored or hit the table, to pick which one a miss
+     replaces.*/
+  uint32_t last_used;
+} pwdc_table_slot;
+
+/*What each context of the current build needs.*/
+typedef enum {
+  /*Copy from a cache slot.*/
+  PWDC_TABLE_HIT,
+  /*Build it.*/
+  PWDC_TABLE_MISS,
+  /*Copy from an earlier context of this build once that is built.*/
+  PWDC_TABLE_DUP,
+} pwdc_table_action;
+
+typedef struct {
+  pwdc_table_action action;
+  /*The cache slot (HIT) or context (DUP) to copy from, or the slot a MISS
+     goes to (UINT32_MAX for none).*/
+  uint32_t src;
+} pwdc_table_plan;
+
+typedef enum {
+  PWDC_TABLE_PHASE_NORMALIZE,
+  PWDC_TABLE_PHASE_BUILD,
+} pwdc_table_phase;
+
+struct pwdc_table_builder {
+  int num_workers;
+  pwdc_table_slot *cache;
+  uint32_t cache_mask;
+  pwdc_table_plan *plan;
+  uint32_t plan_alloc;
+  /*Numbers the builds, from 1.*/
+  uint32_t epoch;
+  pwdc_table_stats stats;
+  /*The build in progress.*/
+  const pwdc_table_hist *hists;
+  pwdc_table *tables;
+  uint32_t n;
+  pwdc_table_phase phase;
+  uint32_t next;
+  /*The num_workers - 1 workers besides the calling thread, of which
+     num_threads were set up.*/
+  AVxWorker *workers;
+  int num_threads;
+#if CONFIG_MULTITHREAD
+  /*Guards next.*/
+  pthread_mutex_t mutex;
+#endif
+};
+
+/*Scales the counts to PWDC_TABLE_TOP, rounding to nearest, and keeps every
+   nonzero count at least 1. The 16 lanes are done as four vectors in single
+   precision; the scalar version does the same arithmetic.*/
+#if defined(PWDC_TABLE_NORM_SSE2)
+static void pwdc_table_scale(const uint32_t *count, float scale,
+                             uint16_t *freq) {
+  const __m128 s = _mm_set1_ps(scale);
+  const __m128 half = _mm_set1_ps(0.5f);
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i one = _mm_set1_epi32(1);
+  __m128i q[4];
+  for (int i = 0; i < 4; i++) {
+    const __m128i c = _mm_loadu_si128((const __m128i *)(count + 4 * i));
+    const __m128 f = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(c), s), half);
+    const __m128i v = _mm_cvttps_epi32(f);
+    /*v == 0 && c != 0 becomes 1.*/
+    const __m128i bump = _mm_andnot_si128(_mm_cmpeq_epi32(c, zero),
+                                          _mm_cmpeq_epi32(v, zero));
+    q[i] = _mm_or_si128(v, _mm_and_si128(bump, one));
+  }
+  /*Every value is at most PWDC_TABLE_TOP, so the signed pack is exact.*/
+  _mm_storeu_si128((__m128i *)freq, _mm_packs_epi32(q[0], q[1]));
+  _mm_storeu_si128((__m128i *)(freq + 8), _mm_packs_epi32(q[2], q[3]));
+}
+#elif defined(PWDC_TABLE_NORM_NEON)
+static void pwdc_table_scale(const uint32_t *count, float scale,
+                             uint16_t *freq) {
+  const float32x4_t s = vdupq_n_f32(scale);
+  const float32x4_t half = vdupq_n_f32(0.5f);
+  const uint32x4_t one = vdupq_n_u32(1);
+  for (int i = 0; i < 16; i += 8) {
+    uint32x4_t q[2];
+    for (int k = 0; k < 2; k++) {
+      const uint32x4_t c = vld1q_u32(count + i + 4 * k);
+      const float32x4_t f = vaddq_f32(vmulq_f32(vcvtq_f32_u32(c), s), half);
+      q[k] = vmaxq_u32(vcvtq_u32_f32(f), vminq_u32(c, one));
+    }
+    vst1q_u16(freq + i, vcombine_u16(vmovn_u32(q[0]), vmovn_u32(q[1])));
+  }
+}
+#else
+static void pwdc_table_scale(const uint32_t *count, float scale,
+                             uint16_t *freq) {
+  for (int i = 0; i < 16; i++) {
+    const int v = (int)((float)count[i] * scale + 0.5f);
+    freq[i] = (uint16_t)(v == 0 && count[i] != 0 ? 1 : v);
+  }
+}
+#endif
+
+void pwdc_table_normalize(const uint32_t *count, int nsyms, uint16_t *freq) {
+  uint32_t c[16];
+  uint64_t total = 0;
+  assert(nsyms >= 1 && nsyms <= 16);
+  for (int i = 0; i < 16; i++) total += count[i];
+  if (total == 0) {
+    memset(freq, 0, 16 * sizeof(*freq));
+    for (int i = 0; i < nsyms; i++) freq[i] = PWDC_TABLE_TOP / nsyms;
+    freq[0] += PWDC_TABLE_TOP % nsyms;
+    return;
+  }
+  /*The vector conversions take signed 32-bit lanes.*/
+  int shift = 0;
+  while (total >> shift > INT32_MAX) shift++;
+  uint32_t scaled = 0;
+  for (int i = 0; i < 16; i++) {
+    c[i] = count[i] >> shift | (shift > 0 && count[i] != 0);
+    scaled += c[i];
+  }
+  pwdc_table_scale(c, (float)PWDC_TABLE_TOP / scaled, freq);
+  /*Rounding error is absorbed by the most likely symbols, where it costs the
+     least, as in pwdc_static.c.*/
+  int sum = 0;
+  int top = 0;
+  for (int i = 0; i < nsyms; i++) {
+    sum += freq[i];
+    if (freq[i] > freq[top]) top = i;
+  }
+  while (sum > PWDC_TABLE_TOP) {
+    int big = 0;
+    for (int i = 1; i < nsyms; i++) {
+      if (freq[i] > freq[big]) big = i;
+    }
+    freq[big]--;
+    sum--;
+  }
+  freq[top] += (uint16_t)(PWDC_TABLE_TOP - sum);
+}
+
+static uint64_t pwdc_table_hash(int nsyms, const uint16_t *freq) {
+  /*FNV-1a.*/
+  uint64_t h = 0xCBF29CE484222325ULL;
+  h = (h ^ (uint64_t)nsyms) * 0x100000001B3ULL;
+  for (int i = 0; i < nsyms; i++) {
+    h = (h ^ freq[i]) * 0x100000001B3ULL;
+  }
+  return h;
+}
+
+static int pwdc_table_same(const pwdc_table *a, const pwdc_table *b) {
+  return a->hash == b->hash && a->nsyms == b->nsyms &&
+         !memcmp(a->freq, b->freq, a->nsyms * sizeof(*a->freq));
+}
+
+void pwdc_table_fill(pwdc_table *t) {
+  const int nsyms = t->nsyms;
+  uint32_t hist[16];
+  int cum = 0;
+  for (int i = 0; i < nsyms; i++) {
+    memset(t->spread + cum, i, t->freq[i]);
+    cum += t->freq[i];
+    t->icdf[i] = (uint16_t)OD_ICDF(cum << EC_PROB_SHIFT);
+    hist[i] = t->freq[i];
+  }
+  assert(cum == PWDC_TABLE_TOP);
+  for (int i = nsyms; i < 16; i++) {
+    t->icdf[i] = 0;
+    t->lens[i] = 0;
+    t->codes[i] = 0;
+  }
+  pwdc_huff_build_lengths(hist, nsyms, PWDC_HUFF_MAX_LEN, t->lens);
+  pwdc_huff_build_codes(t->lens, nsyms, t->codes);
+  t->hash = pwdc_table_hash(nsyms, t->freq);
+}
+
+/*Runs the current phase on contexts [start, end).*/
+static void pwdc_table_run(pwdc_table_builder *b, uint32_t start,
+                           uint32_t end) {
+  for (uint32_t i = start; i < end; i++) {
+    pwdc_table *t = &b->tables[i];
+    if (b->phase == PWDC_TABLE_PHASE_NORMALIZE) {
+      const pwdc_table_hist *h = &b->hists[i];
+      t->nsyms = OD_MINI(OD_MAXI(h->nsyms, 1), 16);
+      pwdc_table_normalize(h->count, t->nsyms, t->freq);
+      t->hash = pwdc_table_hash(t->nsyms, t->freq);
+    } else if (b->plan[i].action == PWDC_TABLE_HIT) {
+      *t = b->cache[b->plan[i].src].table;
+    } else if (b->plan[i].action == PWDC_TABLE_MISS) {
+      pwdc_table_fill(t);
+    }
+  }
+}
+
+/*Claims chunks of the current phase until none are left.*/
+static void pwdc_table_work(pwdc_table_builder *b) {
+  for (;;) {
+    uint32_t start;
+#if CONFIG_MULTITHREAD
+    pthread_mutex_lock(&b->mutex);
+#endif
+    start = b->next;
+    b->next = OD_MINI(start + PWDC_TABLE_CHUNK, b->n);
+#if CONFIG_MULTITHREAD
+    pthread_mutex_unlock(&b->mutex);
+#endif
+    if (start >= b->n) break;
+    pwdc_table_run(b, start, OD_MINI(start + PWDC_TABLE_CHUNK, b->n));
+  }
+}
+
+static int pwdc_table_worker_hook(void *arg1, void *unused) {
+  (void)unused;
+  pwdc_table_work((pwdc_table_builder *)arg1);
+  return 1;
+}
+
+/*Runs one phase over every context on all workers.*/
+static void pwdc_table_phase_run(pwdc_table_builder *b,
+                                 pwdc_table_phase phase) {
+  b->phase = phase;
+  b->next = 0;
+  /*Small builds are not worth waking the workers for.*/
+  if (b->num_threads > 0 && b->n > PWDC_TABLE_CHUNK) {
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    for (int i = 0; i < b->num_threads; i++) {
+      winterface->launch(&b->workers[i]);
+    }
+    pwdc_table_work(b);
+    for (int i = 0; i < b->num_threads; i++) winterface->sync(&b->workers[i]);
+    return;
+  }
+  pwdc_table_work(b);
+}
+
+pwdc_table_builder *pwdc_table_builder_create(int num_workers,
+                                              int cache_slots) {
+  pwdc_table_builder *b = (pwdc_table_builder *)calloc(1, sizeof(*b));
+  if (b == NULL) return NULL;
+#if CONFIG_MULTITHREAD
+  b->num_workers = OD_MAXI(num_workers, 1);
+#else
+  (void)num_workers;
+  b->num_workers = 1;
+#endif
+  if (cache_slots > 0) {
+    uint32_t slots = 1;
+    while (slots < (uint32_t)cache_slots) slots <<= 1;
+    b->cache = (pwdc_table_slot *)calloc(slots, sizeof(*b->cache));
+    if (b->cache == NULL) {
+      free(b);
+      return NULL;
+    }
+    b->cache_mask = slots - 1;
+  }
+#if CONFIG_MULTITHREAD
+  pthread_mutex_init(&b->mutex, NULL);
+#endif
+  if (b->num_workers > 1) {
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    b->workers = (AVxWorker *)calloc(b->num_workers - 1, sizeof(*b->workers));
+    if (b->workers == NULL) {
+      pwdc_table_builder_destroy(b);
+      return NULL;
+    }
+    for (int i = 0; i < b->num_workers - 1; i++) {
+      AVxWorker *const worker = &b->workers[i];
+      winterface->init(worker);
+      worker->thread_name = "pwdc table";
+      /*Counted first, so destroy() ends it even if it fails to start.*/
+      b->num_threads++;
+      if (!winterface->reset(worker)) {
+        pwdc_table_builder_destroy(b);
+        return NULL;
+      }
+      worker->hook = pwdc_table_worker_hook;
+      worker->data1 = b;
+      worker->data2 = NULL;
+    }
+  }
+  return b;
+}
+
+void pwdc_table_builder_destroy(pwdc_table_builder *b) {
+  if (b == NULL) return;
+  if (b->workers != NULL) {
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    for (int i = 0; i < b->num_threads; i++) winterface->end(&b->workers[i]);
+    free(b->workers);
+  }
+#if CONFIG_MULTITHREAD
+  pthread_mutex_destroy(&b->mutex);
+#endif
+  free(b->cache);
+  free(b->plan);
+  free(b);
+}
+
+/*Finds t's distribution among the cached tables and the misses already
+   claimed by this build. Returns the action, with *src set to the cache slot
+   (HIT) or the earlier context (DUP). For a MISS, *src is the first empty
+   probed slot, or else the unclaimed one used longest ago, or UINT32_MAX if
+   this build has claimed them all.*/
+static pwdc_table_action pwdc_table_lookup(const pwdc_table_builder *b,
+                                           const pwdc_table *t,
+                                           uint32_t *src) {
+  const uint32_t home = (uint32_t)t->hash & b->cache_mask;
+  *src = UINT32_MAX;
+  for (uint32_t k = 0; k < PWDC_TABLE_PROBES; k++) {
+    const uint32_t j = (home + k) & b->cache_mask;
+    const pwdc_table_slot *slot = &b->cache[j];
+    if (slot->epoch == b->epoch) {
+      if (pwdc_table_same(&b->tables[slot->owner], t)) {
+        *src = slot->owner;
+        return PWDC_TABLE_DUP;
+      }
+      continue;
+    }
+    if (!slot->used) {
+      *src = j;
+      break;
+    }
+    if (*src == UINT32_MAX ||
+        slot->last_used < b->cache[*src].last_used) {
+      *src = j;
+    }
+    if (pwdc_table_same(&slot->table, t)) {
+      *src = j;
+      return PWDC_TABLE_HIT;
+    }
+  }
+  return PWDC_TABLE_MISS;
+}
+
+int pwdc_table_build(pwdc_table_builder *b, const pwdc_table_hist *hists,
+                     uint32_t n, pwdc_table *tables) {
+  if (n == 0) return 0;
+  if (n > b->plan_alloc) {
+    pwdc_table_plan *plan =
+        (pwdc_table_plan *)realloc(b->plan, n * sizeof(*plan));
+    if (plan == NULL) return -1;
+    b->plan = plan;
+    b->plan_alloc = n;
+  }
+  b->hists = hists;
+  b->tables = tables;
+  b->n = n;
+  pwdc_table_phase_run(b, PWDC_TABLE_PHASE_NORMALIZE);
+
+  /*Decide what each context needs. A miss claims its cache slot for this
+     build right away, so a later context with the same distribution copies
+     its table instead of building it again. Cached tables are not touched
+     until the builds are done, since hits copy from them meanwhile.*/
+  b->epoch++;
+  for (uint32_t i = 0; i < n; i++) {
+    pwdc_table_plan *p = &b->plan[i];
+    b->stats.contexts++;
+    if (b->cache == NULL) {
+      p->action = PWDC_TABLE_MISS;
+      p->src = UINT32_MAX;
+      continue;
+    }
+    p->action = pwdc_table_lookup(b, &tables[i], &p->src);
+    if (p->action != PWDC_TABLE_MISS) {
+      b->stats.hits++;
+      if (p->action == PWDC_TABLE_HIT) b->cache[p->src].last_used = b->epoch;
+    } else if (p->src != UINT32_MAX) {
+      b->cache[p->src].epoch = b->epoch;
+      b->cache[p->src].owner = i;
+    }
+  }
+  pwdc_table_phase_run(b, PWDC_TABLE_PHASE_BUILD);
+
+  for (uint32_t i = 0; i < n; i++) {
+    const pwdc_table_plan *p = &b->plan[i];
+    if (p->action == PWDC_TABLE_MISS) {
+      b->stats.builds++;
+      if (p->src != UINT32_MAX) {
+        b->cache[p->src].table = tables[i];
+        b->cache[p->src].used = 1;
+        b->cache[p->src].last_used = b->epoch;
+      }
+    } else if (p->action == PWDC_TABLE_DUP) {
+      tables[i] = tables[p->src];
+    }
+  }
+  return 0;
+}
+
+void pwdc_table_builder_stats(const pwdc_table_builder *b,
+                              pwdc_table_stats *stats) {
+  *stats = b->stats;
+}
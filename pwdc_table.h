@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2026, Alliance for Open Media. All rights reserved.
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef AOM_AOM_DSP_PWDC_TABLE_H_
+#define AOM_AOM_DSP_PWDC_TABLE_H_
+
+#include "aom_dsp/pwdc_huff.h"
+#include "aom_dsp/pwdc_static.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*Parallel construction of static per-context tables.
+  Each context's histogram is normalized to a power-of-two total, then
+   turned into the tables both static coders need: an icdf for
+   od_ec_encode_cdf_q15() (pwdc_static.h), a length-limited prefix code
+   (pwdc_huff.h), and a decode table that spreads the symbols over the
+   total, mapping each slot to its symbol.
+  A builder runs on a pool of worker threads. It normalizes every context,
+   looks each normalized distribution up in a cache keyed by its hash, and
+   builds only the misses, each distinct one once. The cache lives as long
+   as the builder, so a distribution that comes back in a later frame is
+   copied instead of rebuilt.*/
+
+/*The normalized total, the same precision as the static range coder
+   tables.*/
+#define PWDC_TABLE_BITS (PWDC_STATIC_PROB_BITS)
+#define PWDC_TABLE_TOP (1 << PWDC_TABLE_BITS)
+
+typedef struct {
+  /*Zero above nsyms.*/
+  uint32_t count[16];
+  int nsyms;
+} pwdc_table_hist;
+
+typedef struct {
+  int nsyms;
+  /*Sums to PWDC_TABLE_TOP; every symbol that occurred gets at least 1.*/
+  uint16_t freq[16];
+  uint16_t icdf[16];
+  /*The prefix code, built from freq.*/
+  uint8_t lens[16];
+  uint16_t codes[16];
+  /*Slot to symbol: slots cum(s) to cum(s + 1) - 1 decode to s.*/
+  uint8_t spread[PWDC_TABLE_TOP];
+  /*Hash of nsyms and freq, the cache key.*/
+  uint64_t hash;
+} pwdc_table;
+
+typedef struct pwdc_table_builder pwdc_table_builder;
+
+typedef struct {
+  uint64_t contexts;
+  /*Contexts served from the cache, or from another context of the same
+     build with the same distribution.*/
+  uint64_t hits;
+  uint64_t builds;
+} pwdc_table_stats;
+
+/*Normalizes count (zero above nsyms) to PWDC_TABLE_TOP. An empty histogram
+   gives a flat table.*/
+void pwdc_table_normalize(const uint32_t *count, int nsyms, uint16_t *freq)
+    OD_ARG_NONNULL(1) OD_ARG_NONNULL(3);
+
+/*Fills the rest of t from t->nsyms and t->freq.*/
+void pwdc_table_fill(pwdc_table *t) OD_ARG_NONNULL(1);
+
+/*Creates a builder with num_workers threads, counting the caller, and a
+   cache of cache_slots tables (rounded up to a power of two; 0 disables it).
+  The other threads are AVxWorkers (aom_util/aom_thread.h).
+  Returns NULL on failure.*/
+pwdc_table_builder *pwdc_table_builder_create(int num_workers,
+                                              int cache_slots);
+void pwdc_table_builder_destroy(pwdc_table_builder *b);
+
+/*Builds tables[i] for each of the n histograms. Returns 0 on success.*/
+int pwdc_table_build(pwdc_table_builder *b, const pwdc_table_hist *hists,
+                     uint32_t n, pwdc_table *tables) OD_ARG_NONNULL(1)
+    OD_ARG_NONNULL(2) OD_ARG_NONNULL(4);
+
+/*Totals over every build so far.*/
+void pwdc_table_builder_stats(const pwdc_table_builder *b,
+                              pwdc_table_stats *stats) OD_ARG_NONNULL(1)
+    OD_ARG_NONNULL(2);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AOM_AOM_DSP_PWDC_TABLE_H_